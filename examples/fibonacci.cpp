@@ -1,22 +1,18 @@
 #include <iostream>
-#include <vector>
 #include "BigNum.h"
+#include "BigNumUtils.h"
 
 using namespace std;
 
 int main(void) {
-  // Initialize the first two numbers of the Fibonacci sequence
-  vector<BigNum> fib(101);
-  fib[0] = BigNum("0");
-  fib[1] = BigNum("1");
+  // Print the 100th Fibonacci number using fast doubling
+  cout << fibonacci(100) << endl; // 354224848179261915075
 
-  // Calculate the rest of the Fibonacci sequence
-  for (int i = 2; i <= 100; ++i) {
-    fib[i] = fib[i - 1] + fib[i - 2];
-  }
+  // Print the 100th Lucas number
+  cout << lucas(100) << endl; // 792070839848372253127
 
-  // Print the 100th Fibonacci number
-  cout << fib[100] << endl; // 354224848179261915075
+  // Print the 10^18-th Fibonacci number modulo 10^9 + 7
+  cout << fibonacci(1000000000000000000LL, BigNum("1000000007")) << endl; // 209783453
 
   return 0;
-}
\ No newline at end of file
+}
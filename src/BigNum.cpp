@@ -1,13 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include "BigNum.h"
 
+// Decimal chunks of nine digits, least significant first
+static const uint32_t CHUNK = 1000000000;
+
+////////// BigNumDigits //////////
+
+/**
+ * @brief Take ownership of a digit string
+ * @param s Digit string
+*/
+BigNumDigits::BigNumDigits(std::string s) : data(std::make_shared<std::string>(std::move(s))), dot(data->find('.')) {}
+
+BigNumDigits &BigNumDigits::operator=(std::string s) {
+  data = std::make_shared<std::string>(std::move(s));
+  dot = data->find('.');
+  return *this;
+}
+
+BigNumDigits::operator const std::string &(void) const { return *data; }
+const std::string &BigNumDigits::str(void) const { return *data; }
+
+/**
+ * @brief Mutable access to the digits
+ * @details Copies the digits first if they are shared with another BigNum,
+ *          so edits never show through other copies. The reference is only
+ *          valid until the next copy or assignment. The cached decimal point
+ *          goes stale until sync.
+ * @return Digit string owned by this object alone
+*/
+std::string &BigNumDigits::edit(void) {
+  dot = STALE;
+  if (data.use_count() > 1) {
+    data = std::make_shared<std::string>(*data);
+  } else {
+    // use_count() is a relaxed load; the fence pairs with the release in the
+    // last other owner's decrement, so its reads finish before our writes
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *data;
+}
+
+/**
+ * @brief Recompute the cached decimal point after an edit
+*/
+void BigNumDigits::sync(void) { dot = data->find('.'); }
+
+long BigNumDigits::use_count(void) const { return data.use_count(); }
+
+/**
+ * @brief Position of the decimal point
+ * @details Cached when the digits are assigned, so this is O(1) unless the
+ *          digits were edited since the last sync
+ * @return Index of the decimal point, npos for integers
+*/
+size_t BigNumDigits::point(void) const { return dot != STALE ? dot : data->find('.'); }
+
+size_t BigNumDigits::length(void) const { return data->length(); }
+size_t BigNumDigits::size(void) const { return data->size(); }
+bool BigNumDigits::empty(void) const { return data->empty(); }
+const char &BigNumDigits::operator[](const size_t &i) const { return (*data)[i]; }
+const char &BigNumDigits::front(void) const { return data->front(); }
+const char &BigNumDigits::back(void) const { return data->back(); }
+const char *BigNumDigits::c_str(void) const { return data->c_str(); }
+std::string::const_iterator BigNumDigits::begin(void) const { return data->cbegin(); }
+std::string::const_iterator BigNumDigits::end(void) const { return data->cend(); }
+std::string BigNumDigits::substr(const size_t &pos, const size_t &n) const { return data->substr(pos, n); }
+size_t BigNumDigits::find_first_of(const char &c, const size_t &pos) const { return data->find_first_of(c, pos); }
+size_t BigNumDigits::find_first_of(const char *chars, const size_t &pos) const { return data->find_first_of(chars, pos); }
+size_t BigNumDigits::find_first_not_of(const char &c, const size_t &pos) const { return data->find_first_not_of(c, pos); }
+size_t BigNumDigits::find_first_not_of(const char *chars, const size_t &pos) const { return data->find_first_not_of(chars, pos); }
+size_t BigNumDigits::find_last_not_of(const char &c, const size_t &pos) const { return data->find_last_not_of(c, pos); }
+size_t BigNumDigits::find_last_not_of(const char *chars, const size_t &pos) const { return data->find_last_not_of(chars, pos); }
+
+bool operator==(const BigNumDigits &a, const BigNumDigits &b) { return a.str() == b.str(); }
+bool operator==(const BigNumDigits &a, const std::string &b) { return a.str() == b; }
+bool operator==(const BigNumDigits &a, const char *b) { return a.str() == b; }
+bool operator!=(const BigNumDigits &a, const BigNumDigits &b) { return !(a == b); }
+bool operator!=(const BigNumDigits &a, const std::string &b) { return !(a == b); }
+bool operator!=(const BigNumDigits &a, const char *b) { return !(a == b); }
+bool operator<(const BigNumDigits &a, const BigNumDigits &b) { return a.str() < b.str(); }
+std::string operator+(const BigNumDigits &a, const std::string &b) { return a.str() + b; }
+std::string operator+(const std::string &a, const BigNumDigits &b) { return a + b.str(); }
+std::ostream &operator<<(std::ostream &os, const BigNumDigits &d) { return os << d.str(); }
+
+/**
+ * @brief Trimmed copy of a digit string
+*/
+static std::string trimmed(std::string s) {
+  BigNum::trim(s);
+  return s;
+}
+
+/**
+ * @brief Digits of zero, shared by every default-constructed BigNum
+*/
+static const BigNumDigits &zero_digits(void) {
+  static const BigNumDigits zero(std::string("0"));
+  return zero;
+}
+
+/**
+ * @brief Exact digits of a long double
+ * @details |n| = f * 2 ^ e with f in [0.5, 1); the bits of f are read 32 at a
+ *          time into an integer m, so |n| = m * 2 ^ k. For k < 0 the result is
+ *          m * 5 ^ -k / 10 ^ -k, and m * 5 ^ -k is m * 10 ^ -k shifted right
+ *          by -k bits, which is exact.
+ * @param n Number
+ * @return Digits of |n|
+ * @throws Not a finite number
+*/
+static std::string from_long_double(const long double &n) {
+  if (!std::isfinite(n)) throw "Not a finite number";
+  int e = 0;
+  long double f = std::frexp(std::fabs(n), &e);
+  std::string m = "0";
+  long long k = e;
+  while (f != 0) {
+    f = std::ldexp(f, 32);
+    uint32_t chunk = (uint32_t)f;
+    f -= chunk;
+    m = BigNum::add(BigNum::shl(m, 32), std::to_string(chunk));
+    k -= 32;
+  }
+  if (k >= 0) return trimmed(BigNum::shl(m, k));
+
+  std::string digits = BigNum::shr(m + std::string(-k, '0'), -k);
+  if ((long long)digits.length() <= -k) digits.insert(0, -k - digits.length() + 1, '0');
+  digits.insert(digits.length() + k, 1, '.');
+  return trimmed(digits);
+}
+
 ////////// Constructors //////////
 
-BigNum::BigNum(void) : num("0"), sign(true) {}
-BigNum::BigNum(const BigNum &bn) : num(bn.num), sign(bn.sign) { trim(this->num); }
-BigNum::BigNum(const long long &n) : sign(n >= 0), num(std::to_string(n)) { trim(this->num); }
-BigNum::BigNum(const long double &n) : sign(n >= 0), num(std::to_string(n)) { trim(this->num); }
-BigNum::BigNum(const std::string &s) : sign(s[0] != '-'), num(s[0] == '-' ? s.substr(1) : s) { trim(this->num); }
-BigNum::BigNum(const bool &s, const std::string &n) : sign(s), num(n) { trim(this->num); }
+BigNum::BigNum(void) : num(zero_digits()), sign(true) {}
+BigNum::BigNum(const long long &n) : num(trimmed(std::to_string(n).substr(n < 0 ? 1 : 0))), sign(n >= 0) {}
+BigNum::BigNum(const long double &n) : num(from_long_double(n)), sign(n >= 0) { sign |= num == "0"; }
+BigNum::BigNum(const std::string &s) : num(trimmed(s[0] == '-' ? s.substr(1) : s)), sign(s[0] != '-') { sign |= num == "0"; }
+BigNum::BigNum(const bool &s, std::string n) : num(trimmed(std::move(n))), sign(s) { sign |= num == "0"; }
+BigNum::BigNum(const bool &s, const BigNumDigits &n) : num(n), sign(s) { sign |= num == "0"; }
 
 ////////// Input & Output //////////
 
@@ -26,69 +161,117 @@ std::ostream &operator<<(std::ostream &os, const BigNum &bn) {
 
 ////////// Assignment operators //////////
 
-BigNum &BigNum::operator=(const BigNum &bn) {
-  if (this != &bn) {
-    this->sign = bn.sign;
-    this->num = bn.num;
-  }
-  return *this;
-}
 BigNum &BigNum::operator=(const long long &n) { return *this = BigNum(n); }
 BigNum &BigNum::operator=(const std::string &s) { return *this = BigNum(s); }
 
 ////////// Addition operators //////////
 
-BigNum BigNum::operator+(const BigNum &bn) {
-  if (this->sign == bn.sign) return BigNum(this->sign, add(this->num, bn.num));
-  else if (*this >= bn)      return BigNum(this->sign, sub(this->num, bn.num));
-  else                       return BigNum(!this->sign, sub(bn.num, this->num));
+BigNum BigNum::operator+(const BigNum &bn) const {
+  if (this->sign == bn.sign)           return BigNum(this->sign, add(this->num, bn.num));
+  else if (abs_geq(this->num, bn.num)) return BigNum(this->sign, sub(this->num, bn.num));
+  else                                 return BigNum(!this->sign, sub(bn.num, this->num));
 }
-BigNum BigNum::operator+(const long long &n) { return *this + BigNum(n); }
-BigNum BigNum::operator+(const std::string &s) { return *this + BigNum(s); }
+BigNum BigNum::operator+(const long long &n) const { return *this + BigNum(n); }
+BigNum BigNum::operator+(const std::string &s) const { return *this + BigNum(s); }
 BigNum BigNum::operator+=(const BigNum &bn) { return *this = *this + bn; }
 BigNum BigNum::operator+=(const long long &n) { return *this = *this + n; }
 BigNum BigNum::operator+=(const std::string &s) { return *this = *this + s; }
 
 ////////// Subtraction operators //////////
 
-BigNum BigNum::operator-(const BigNum &bn) {
-  if (this->sign != bn.sign) return BigNum(this->sign, add(this->num, bn.num));
-  else if (*this >= bn)      return BigNum(this->sign, sub(this->num, bn.num));
-  else                       return BigNum(!this->sign, sub(bn.num, this->num));
+BigNum BigNum::operator-(const BigNum &bn) const {
+  if (this->sign != bn.sign)           return BigNum(this->sign, add(this->num, bn.num));
+  else if (abs_geq(this->num, bn.num)) return BigNum(this->sign, sub(this->num, bn.num));
+  else                                 return BigNum(!this->sign, sub(bn.num, this->num));
 }
-BigNum BigNum::operator-(const long long &n) { return *this - BigNum(n); }
-BigNum BigNum::operator-(const std::string &s) { return *this - BigNum(s); }
+BigNum BigNum::operator-(const long long &n) const { return *this - BigNum(n); }
+BigNum BigNum::operator-(const std::string &s) const { return *this - BigNum(s); }
 BigNum BigNum::operator-=(const BigNum &bn) { return *this = *this - bn; }
 BigNum BigNum::operator-=(const long long &n) { return *this = *this - n; }
 BigNum BigNum::operator-=(const std::string &s) { return *this = *this - s; }
 
 ////////// Multiplication operators //////////
 
-BigNum BigNum::operator*(const BigNum &bn) { return BigNum(this->sign == bn.sign, mul(this->num, bn.num)); }
-BigNum BigNum::operator*(const long long &n) { return *this * BigNum(n); }
-BigNum BigNum::operator*(const std::string &s) { return *this * BigNum(s); }
+BigNum BigNum::operator*(const BigNum &bn) const { return BigNum(this->sign == bn.sign, mul(this->num, bn.num)); }
+BigNum BigNum::operator*(const long long &n) const { return *this * BigNum(n); }
+BigNum BigNum::operator*(const std::string &s) const { return *this * BigNum(s); }
 BigNum BigNum::operator*=(const BigNum &bn) { return *this = *this * bn; }
 BigNum BigNum::operator*=(const long long &n) { return *this = *this * n; }
 BigNum BigNum::operator*=(const std::string &s) { return *this = *this * s; }
 
 ////////// Division operators //////////
 
-BigNum BigNum::operator/(const BigNum &bn) { return BigNum(this->sign == bn.sign, div(this->num, bn.num)); }
-BigNum BigNum::operator/(const long long &n) { return *this / BigNum(n); }
-BigNum BigNum::operator/(const std::string &s) { return *this / BigNum(s); }
+BigNum BigNum::operator/(const BigNum &bn) const { return BigNum(this->sign == bn.sign, div(this->num, bn.num)); }
+BigNum BigNum::operator/(const long long &n) const { return *this / BigNum(n); }
+BigNum BigNum::operator/(const std::string &s) const { return *this / BigNum(s); }
 BigNum BigNum::operator/=(const BigNum &bn) { return *this = *this / bn; }
 BigNum BigNum::operator/=(const long long &n) { return *this = *this / n; }
 BigNum BigNum::operator/=(const std::string &s) { return *this = *this / s; }
 
 ////////// Modulo operators //////////
 
-BigNum BigNum::operator%(const BigNum &bn) { return *this - (*this / bn) * bn; }
-BigNum BigNum::operator%(const long long &n) { return *this % BigNum(n); }
-BigNum BigNum::operator%(const std::string &s) { return *this % BigNum(s); }
+BigNum BigNum::operator%(const BigNum &bn) const { return *this - (*this / bn) * bn; }
+BigNum BigNum::operator%(const long long &n) const { return *this % BigNum(n); }
+BigNum BigNum::operator%(const std::string &s) const { return *this % BigNum(s); }
 BigNum BigNum::operator%=(const BigNum &bn) { return *this = *this % bn; }
 BigNum BigNum::operator%=(const long long &n) { return *this = *this % n; }
 BigNum BigNum::operator%=(const std::string &s) { return *this = *this % s; }
 
+////////// Shift operators //////////
+
+/**
+ * @brief Reject decimal operands
+ * @details Helper function for the shift, bitwise and bit query functions,
+ *          which are only defined on integers
+ * @param bn Number to check
+ * @throws Decimal number
+*/
+static void check_integer(const BigNum &bn) {
+  if (bn.num.point() != std::string::npos) throw "Decimal number";
+}
+
+BigNum BigNum::operator<<(const long long &k) const {
+  check_integer(*this);
+  if (k < 0) return *this >> -k;
+  return BigNum(this->sign, shl(this->num, k));
+}
+BigNum BigNum::operator>>(const long long &k) const {
+  check_integer(*this);
+  if (k < 0) return *this << -k;
+  if (this->sign) return BigNum(true, shr(this->num, k));
+  // Round toward negative infinity: -x >> k = -(((x - 1) >> k) + 1)
+  return BigNum(false, add(shr(sub(this->num, "1"), k), "1"));
+}
+BigNum BigNum::operator<<=(const long long &k) { return *this = *this << k; }
+BigNum BigNum::operator>>=(const long long &k) { return *this = *this >> k; }
+
+////////// Bitwise operators //////////
+
+BigNum BigNum::operator&(const BigNum &bn) const { return bitwise(bn, '&'); }
+BigNum BigNum::operator&(const long long &n) const { return *this & BigNum(n); }
+BigNum BigNum::operator&(const std::string &s) const { return *this & BigNum(s); }
+BigNum BigNum::operator&=(const BigNum &bn) { return *this = *this & bn; }
+BigNum BigNum::operator&=(const long long &n) { return *this = *this & n; }
+BigNum BigNum::operator&=(const std::string &s) { return *this = *this & s; }
+BigNum BigNum::operator|(const BigNum &bn) const { return bitwise(bn, '|'); }
+BigNum BigNum::operator|(const long long &n) const { return *this | BigNum(n); }
+BigNum BigNum::operator|(const std::string &s) const { return *this | BigNum(s); }
+BigNum BigNum::operator|=(const BigNum &bn) { return *this = *this | bn; }
+BigNum BigNum::operator|=(const long long &n) { return *this = *this | n; }
+BigNum BigNum::operator|=(const std::string &s) { return *this = *this | s; }
+BigNum BigNum::operator^(const BigNum &bn) const { return bitwise(bn, '^'); }
+BigNum BigNum::operator^(const long long &n) const { return *this ^ BigNum(n); }
+BigNum BigNum::operator^(const std::string &s) const { return *this ^ BigNum(s); }
+BigNum BigNum::operator^=(const BigNum &bn) { return *this = *this ^ bn; }
+BigNum BigNum::operator^=(const long long &n) { return *this = *this ^ n; }
+BigNum BigNum::operator^=(const std::string &s) { return *this = *this ^ s; }
+BigNum BigNum::operator~(void) const {
+  check_integer(*this);
+  // ~x = -x - 1
+  if (this->sign) return BigNum(false, add(this->num, "1"));
+  else            return BigNum(true, sub(this->num, "1"));
+}
+
 ////////// Comparison operators //////////
 
 bool BigNum::operator==(const BigNum &bn) const { return this->num == bn.num && this->sign == bn.sign; }
@@ -110,6 +293,259 @@ bool BigNum::operator>=(const BigNum &bn) const { return !(*this < bn); }
 bool BigNum::operator>=(const long long &n) const { return !(*this < n); }
 bool BigNum::operator>=(const std::string &s) const { return !(*this < s); }
 
+////////// Storage //////////
+
+/**
+ * @brief Reserve room for a number of digits
+ * @details Unshares the digits, so later in-place arithmetic on this BigNum
+ *          up to that size does not allocate
+ * @param digits Number of digits, including a decimal point
+*/
+void BigNum::reserve(const size_t &digits) {
+  this->num.edit().reserve(digits);
+  this->num.sync();
+}
+
+/**
+ * @brief Release unused capacity
+*/
+void BigNum::shrink_to_fit(void) {
+  this->num.edit().shrink_to_fit();
+  this->num.sync();
+}
+
+size_t BigNum::capacity(void) const { return this->num.str().capacity(); }
+
+////////// Bit queries //////////
+
+/**
+ * @brief Power of two as a digit string
+ * @details Helper function for bit_length
+ *          Binary exponentiation on Karatsuba squares
+ * @param k Exponent, non-negative
+ * @return 2 ^ k
+*/
+static std::string pow2(long long k) {
+  std::string r = "1";
+  for (int i = 62; i >= 0; --i) {
+    if (r != "1") r = BigNum::karatsuba(r, r);
+    if ((k >> i) & 1) r = BigNum::add(r, r);
+  }
+  return r;
+}
+
+/**
+ * @brief Number of bits in the magnitude
+ * @details Estimated from log2() on the first 17 digits; only when log2 is
+ *          too close to an integer to decide is |x| compared with the power
+ *          of two exactly, an O(M(n)) step instead of quadratic base
+ *          conversion
+ * @return Smallest b with |x| < 2 ^ b, 0 for zero
+ * @throws Decimal number
+*/
+long long BigNum::bit_length(void) const {
+  check_integer(*this);
+  const std::string &s = this->num;
+  if (s.length() <= 18) {
+    long long bits = 0;
+    for (unsigned long long v = std::stoull(s); v; v >>= 1) ++bits;
+    return bits;
+  }
+
+  // log2 is off by a few ulps of its magnitude plus the 17-digit truncation
+  double l = BigNum(true, this->num).log2(), eps = 1e-9 + l * 1e-12;
+  long long lo = (long long)std::floor(l - eps), hi = (long long)std::floor(l + eps);
+  if (lo == hi) return lo + 1;
+  std::string p = pow2(hi);
+  bool geq = s.length() != p.length() ? s.length() > p.length() : s >= p;
+  return geq ? hi + 1 : hi;
+}
+
+/**
+ * @brief Number of set bits in the magnitude
+ * @details Quadratic, as every bit is needed and to_limbs converts the whole
+ *          number by repeated short division
+ * @return Population count of |x|
+ * @throws Decimal number
+*/
+long long BigNum::popcount(void) const {
+  check_integer(*this);
+  long long cnt = 0;
+  for (uint32_t limb : to_limbs(this->num)) {
+    for (; limb; limb &= limb - 1) ++cnt;
+  }
+  return cnt;
+}
+
+/**
+ * @brief Test a single bit in two's complement
+ * @details Negative numbers behave as if sign-extended infinitely
+ *          O(n * i / 32) for n digits, as shr makes one pass per 32 bits
+ * @param i Bit index
+ * @return Whether bit i is set
+ * @throws Decimal number
+*/
+bool BigNum::test_bit(const long long &i) const {
+  check_integer(*this);
+  if (i < 0) return false;
+  if (this->sign) return (shr(this->num, i).back() - '0') & 1;
+  // Bits of -x are the complemented bits of x - 1
+  BigNum m(true, this->num);
+  return !((shr((m - 1LL).num, i).back() - '0') & 1);
+}
+
+/**
+ * @brief Number of trailing zero bits
+ * @details Since 10 ^ 9 = 2 ^ 9 * 5 ^ 9, the lowest nine bits depend only on
+ *          the lowest nine decimal digits, so whole groups of nine zero bits
+ *          are stripped with one linear pass each, O(n * k / 9) in total
+ * @return Largest k such that 2 ^ k divides x, 0 for zero
+ * @throws Decimal number
+*/
+long long BigNum::trailing_zeros(void) const {
+  check_integer(*this);
+  if (this->num == "0") return 0;
+  std::string m = this->num;
+  long long cnt = 0;
+  while (true) {
+    uint32_t low = std::stoul(m.substr(m.length() > 9 ? m.length() - 9 : 0));
+    if (low & 511) {
+      for (; !(low & 1); low >>= 1) ++cnt;
+      return cnt;
+    }
+    m = shr(m, 9);
+    cnt += 9;
+  }
+}
+
+////////// Magnitude queries //////////
+
+/**
+ * @brief First significant digits of a digit string
+ * @details Assume s is normalized and not zero
+ *          Reads only the leading zeros of a number below 1 and the digits
+ *          taken, never the whole string
+ * @param s Digit string
+ * @param point Index of the decimal point in s, npos for integers
+ * @param k Maximum number of digits
+ * @param exp Output decimal exponent of the first significant digit
+ * @param pos Output index in s past the last digit taken
+ * @return Up to k significant digits
+*/
+static std::string significant(const std::string &s, const size_t &point, const size_t &k, long long &exp, size_t &pos) {
+  size_t dot = point == std::string::npos ? s.length() : point;
+  size_t first = s.find_first_not_of("0.");
+  exp = first < dot ? (long long)(dot - first) - 1 : -(long long)(first - dot);
+
+  std::string d;
+  d.reserve(std::min(k, s.length()));
+  for (pos = first; pos < s.length() && d.length() < k; ++pos) {
+    if (s[pos] != '.') d.push_back(s[pos]);
+  }
+  return d;
+}
+
+/**
+ * @brief Number of digits of the integer part
+ * @details O(1) from the cached decimal point
+ * @return Digits before the decimal point, 1 if |x| < 1
+*/
+long long BigNum::digits10(void) const {
+  size_t dot = this->num.point();
+  size_t n = dot == std::string::npos ? this->num.length() : dot;
+  return n ? n : 1;
+}
+
+/**
+ * @brief Leading significant digits
+ * @details Reads only the first k digits, truncating the rest
+ * @param k Number of digits
+ * @return Up to k digits of |x| starting at the first non-zero digit
+*/
+std::string BigNum::leading_digits(const long long &k) const {
+  if (k <= 0) return "";
+  if (this->num == "0") return "0";
+  long long exp;
+  size_t pos;
+  return significant(this->num, this->num.point(), k, exp, pos);
+}
+
+/**
+ * @brief Scientific notation
+ * @details Reads only the first precision + 2 digits and rounds half away
+ *          from zero, in the format of printf's %.*e
+ * @param precision Digits after the decimal point
+ * @return e.g. "-1.235e+04"
+*/
+std::string BigNum::to_scientific(const int &precision) const {
+  size_t p = precision > 0 ? precision : 0;
+  long long exp = 0;
+  size_t pos;
+  std::string d = this->num == "0" ? "0" : significant(this->num, this->num.point(), p + 2, exp, pos);
+
+  // Round to p + 1 digits
+  bool up = d.length() > p + 1 && d[p + 1] >= '5';
+  d.resize(p + 1, '0');
+  for (size_t i = p + 1; up && i-- > 0;) {
+    up = d[i] == '9';
+    d[i] = up ? '0' : d[i] + 1;
+  }
+  if (up) {
+    d.insert(0, 1, '1');
+    d.pop_back();
+    ++exp;
+  }
+
+  std::string res = this->sign ? "" : "-";
+  res += d[0];
+  if (p) res += "." + d.substr(1);
+  std::string e = std::to_string(exp < 0 ? -exp : exp);
+  res += exp < 0 ? "e-" : "e+";
+  if (e.length() < 2) res += '0';
+  return res + e;
+}
+
+/**
+ * @brief Nearest double
+ * @details A double halfway point has at most 767 significant digits, so
+ *          the first 800 digits round exactly like the full number unless
+ *          they end in 33 zeros and may sit on a halfway point. Only then is
+ *          the rest scanned, for a sticky 1 if any digit is non-zero.
+ * @return Correctly rounded value, +-inf when out of range
+*/
+double BigNum::to_double(void) const {
+  if (this->num == "0") return 0.0;
+  long long exp;
+  size_t pos;
+  std::string d = significant(this->num, this->num.point(), 800, exp, pos);
+  bool halfway = d.length() == 800 && d.find_last_not_of('0') < 767;
+  if (halfway && this->num.find_first_of("123456789", pos) != std::string::npos) d.push_back('1');
+  d += "e" + std::to_string(exp - (long long)d.length() + 1);
+  double res = std::strtod(d.c_str(), nullptr);
+  return this->sign ? res : -res;
+}
+
+/**
+ * @brief Approximate base 2 logarithm
+ * @return log2(x), -inf for zero, NaN for negative numbers
+*/
+double BigNum::log2(void) const { return this->log10() / std::log10(2.0); }
+
+/**
+ * @brief Approximate base 10 logarithm
+ * @details Reads the first 17 digits, so it works far beyond double range
+ * @return log10(x), -inf for zero, NaN for negative numbers
+*/
+double BigNum::log10(void) const {
+  if (this->num == "0") return -std::numeric_limits<double>::infinity();
+  if (!this->sign) return std::numeric_limits<double>::quiet_NaN();
+  long long exp;
+  size_t pos;
+  std::string d = significant(this->num, this->num.point(), 17, exp, pos);
+  double mantissa = std::strtod(("." + d).c_str(), nullptr);
+  return std::log10(mantissa) + exp + 1;
+}
+
 ////////// Helper functions //////////
 
 /**
@@ -162,6 +598,175 @@ void BigNum::padding(std::string &a, std::string &b) {
   if (dotA < dotB) a.insert(0, std::string(dotB - dotA, '0'));
 }
 
+/**
+ * @brief Pad the digits of two BigNums in place
+ * @details Unshares the digits of a and b before editing them
+ * @param a First digits
+ * @param b Second digits
+*/
+void BigNum::padding(BigNumDigits &a, BigNumDigits &b) {
+  padding(a.edit(), b.edit());
+  a.sync();
+  b.sync();
+}
+
+/**
+ * @brief Compare the magnitudes of two strings
+ * @details Assume a, b are non-negative
+ *          This function is used in add, sub to pick the sign of the result
+ * @param a First string
+ * @param b Second string
+ * @return Whether a >= b
+*/
+bool BigNum::abs_geq(std::string a, std::string b) {
+  padding(a, b);
+  return a >= b;
+}
+
+////////// Limb arithmetic //////////
+
+// Below this many limbs in the shorter operand, karatsuba falls back to the schoolbook product
+static const size_t KARATSUBA_LIMBS = 32;
+
+/**
+ * @brief Split a string into chunks of nine digits
+ * @details Assume a is a non-negative integer
+ *          Helper function for karatsuba, shl, shr, to_limbs
+ * @param a String
+ * @return Chunks in base 10 ^ 9, least significant first
+*/
+static std::vector<uint32_t> to_chunks(const std::string &a) {
+  std::vector<uint32_t> c;
+  c.reserve(a.length() / 9 + 1);
+  for (int end = a.length(); end > 0; end -= 9) {
+    uint32_t chunk = 0;
+    for (int i = end > 9 ? end - 9 : 0; i < end; ++i) chunk = chunk * 10 + (a[i] - '0');
+    c.push_back(chunk);
+  }
+  while (!c.empty() && c.back() == 0) c.pop_back();
+  return c;
+}
+
+/**
+ * @brief Join chunks of nine digits into a string
+ * @details Helper function for karatsuba, shl, shr, from_limbs
+ * @param c Chunks in base 10 ^ 9, least significant first
+ * @return String
+*/
+static std::string from_chunks(const std::vector<uint32_t> &c) {
+  int top = c.size() - 1;
+  while (top >= 0 && c[top] == 0) --top;
+  if (top < 0) return "0";
+
+  std::string s = std::to_string(c[top]);
+  s.reserve(s.length() + 9 * top);
+  for (int i = top - 1; i >= 0; --i) {
+    std::string chunk = std::to_string(c[i]);
+    s.append(9 - chunk.length(), '0');
+    s.append(chunk);
+  }
+  return s;
+}
+
+/**
+ * @brief Schoolbook product of limbs
+ * @param x First magnitude
+ * @param y Second magnitude
+ * @param out Output magnitude
+*/
+static void mul_limbs(const std::vector<uint32_t> &x, const std::vector<uint32_t> &y, std::vector<uint32_t> &out) {
+  out.assign(x.size() + y.size(), 0);
+  for (size_t i = 0; i < x.size(); ++i) {
+    if (x[i] == 0) continue;
+    uint64_t carry = 0;
+    for (size_t j = 0; j < y.size(); ++j) {
+      uint64_t t = out[i + j] + (uint64_t)x[i] * y[j] + carry;
+      out[i + j] = t % CHUNK;
+      carry = t / CHUNK;
+    }
+    out[i + y.size()] = carry;
+  }
+}
+
+/**
+ * @brief Add limbs at an offset
+ * @details Helper function for mul_karatsuba
+ * @param x Magnitude, replaced by x + y * 10 ^ (9 * shift)
+ * @param y Magnitude
+ * @param shift Offset in limbs
+*/
+static void add_limbs(std::vector<uint32_t> &x, const std::vector<uint32_t> &y, const size_t &shift) {
+  if (x.size() < y.size() + shift) x.resize(y.size() + shift, 0);
+  uint32_t carry = 0;
+  size_t i = shift;
+  for (size_t j = 0; j < y.size(); ++i, ++j) {
+    uint32_t t = x[i] + y[j] + carry;
+    carry = t >= CHUNK;
+    x[i] = carry ? t - CHUNK : t;
+  }
+  for (; carry; ++i) {
+    if (i == x.size()) x.push_back(0);
+    carry = x[i] == CHUNK - 1;
+    x[i] = carry ? 0 : x[i] + 1;
+  }
+}
+
+/**
+ * @brief Subtract limbs in place
+ * @details Assume x >= y and y has no leading zero limbs
+ *          Helper function for mul_karatsuba
+ * @param x Magnitude, replaced by x - y
+ * @param y Magnitude
+*/
+static void sub_limbs(std::vector<uint32_t> &x, const std::vector<uint32_t> &y) {
+  uint32_t borrow = 0;
+  for (size_t i = 0; i < x.size() && (i < y.size() || borrow); ++i) {
+    uint32_t d = (i < y.size() ? y[i] : 0) + borrow;
+    borrow = x[i] < d;
+    x[i] = borrow ? x[i] + CHUNK - d : x[i] - d;
+  }
+  while (!x.empty() && x.back() == 0) x.pop_back();
+}
+
+/**
+ * @brief Karatsuba product of limbs
+ * @details Splits the longer operand in half and recurses on three half-size
+ *          products; a much shorter operand is multiplied slice by slice instead
+ * @param x First magnitude
+ * @param y Second magnitude
+ * @return Product of x and y, without leading zero limbs
+ * @see https://en.wikipedia.org/wiki/Karatsuba_algorithm
+*/
+static std::vector<uint32_t> mul_karatsuba(const std::vector<uint32_t> &x, const std::vector<uint32_t> &y) {
+  if (x.size() < y.size()) return mul_karatsuba(y, x);
+
+  std::vector<uint32_t> out;
+  if (y.size() < KARATSUBA_LIMBS) {
+    mul_limbs(x, y, out);
+  } else if (y.size() * 2 <= x.size()) {
+    // Unbalanced: multiply y by slices of x of its own length
+    for (size_t i = 0; i < x.size(); i += y.size()) {
+      std::vector<uint32_t> slice(x.begin() + i, x.begin() + std::min(i + y.size(), x.size()));
+      add_limbs(out, mul_karatsuba(slice, y), i);
+    }
+  } else {
+    size_t half = x.size() / 2;
+    std::vector<uint32_t> x0(x.begin(), x.begin() + half), x1(x.begin() + half, x.end());
+    std::vector<uint32_t> y0(y.begin(), y.begin() + half), y1(y.begin() + half, y.end());
+    std::vector<uint32_t> p0 = mul_karatsuba(x0, y0), p2 = mul_karatsuba(x1, y1);
+    add_limbs(x0, x1, 0);
+    add_limbs(y0, y1, 0);
+    std::vector<uint32_t> p1 = mul_karatsuba(x0, y0);
+    sub_limbs(p1, p0);
+    sub_limbs(p1, p2);
+    out = p0;
+    add_limbs(out, p1, half);
+    add_limbs(out, p2, half * 2);
+  }
+  while (!out.empty() && out.back() == 0) out.pop_back();
+  return out;
+}
+
 ////////// Basic operations //////////
 
 /**
@@ -175,19 +780,19 @@ void BigNum::padding(std::string &a, std::string &b) {
 std::string BigNum::add(std::string a, std::string b) {
   padding(a, b);
 
-  // String addition
-  std::string c = "";
+  // String addition, written from the back into c[1..] with the carry in c[0]
+  std::string c(a.length() + 1, '0');
   int carry = 0, sum = 0;
   for (int i = a.length() - 1; i >= 0; --i) {
     if (a[i] == '.') {
-      c.insert(0, 1, '.');
+      c[i + 1] = '.';
       continue;
     }
     sum = (a[i] - '0') + (b[i] - '0') + carry;
     carry = sum / 10;
-    c.insert(0, 1, (char)(sum % 10 + '0'));
+    c[i + 1] = (char)(sum % 10 + '0');
   }
-  if (carry) c.insert(0, 1, (char)(carry + '0'));
+  c[0] = (char)(carry + '0');
   trim(c);
 
   return c;
@@ -204,17 +809,17 @@ std::string BigNum::add(std::string a, std::string b) {
 std::string BigNum::sub(std::string a, std::string b) {
   padding(a, b);
 
-  // String subtraction
-  std::string c = "";
+  // String subtraction, written from the back in place
+  std::string c(a.length(), '0');
   int borrow = 0, diff = 0;
   for (int i = a.length() - 1; i >= 0; --i) {
     if (a[i] == '.') {
-      c.insert(0, 1, '.');
+      c[i] = '.';
       continue;
     }
     diff = (a[i] - '0') - (b[i] - '0') - borrow;
     borrow = diff < 0 ? 1 : 0;
-    c.insert(0, 1, (char)(diff + borrow * 10 + '0'));
+    c[i] = (char)(diff + borrow * 10 + '0');
   }
   trim(c);
 
@@ -225,27 +830,14 @@ std::string BigNum::sub(std::string a, std::string b) {
  * @brief Implementation of Karatsuba algorithm
  * @details Divide and conquer algorithm for fast multiplication
  *          Assume a, b are non-negative and integers
+ *          Works on base 10 ^ 9 limbs, so each step handles nine digits at once
  * @param a First string
  * @param b Second string
  * @return Product of a and b
  * @see https://en.wikipedia.org/wiki/Karatsuba_algorithm
 */
 std::string BigNum::karatsuba(std::string a, std::string b) {
-  // Threshold for simple multiplication
-  if (a.length() <= 18 && b.length() <= 18) {
-    return std::to_string(std::stoll(a) * std::stoll(b));
-  }
-
-  int half = (a.length() > b.length() ? a.length() : b.length()) >> 1;
-  int aHalf = a.length() - half, bHalf = b.length() - half;
-  std::string p1 = karatsuba(a.substr(0, aHalf), b.substr(0, bHalf));
-  std::string p2 = karatsuba(a.substr(aHalf), b.substr(bHalf));
-  std::string p3 = karatsuba(add(a.substr(0, aHalf), a.substr(aHalf)), add(b.substr(0, bHalf), b.substr(bHalf)));
-  std::string c = add(p1 + std::string(half << 1, '0'), p2);
-  c = add(c, sub(p3, add(p1, p2)) + std::string(half, '0'));
-  trim(c);
-
-  return c;
+  return from_chunks(mul_karatsuba(to_chunks(a), to_chunks(b)));
 }
 
 /**
@@ -273,7 +865,11 @@ std::string BigNum::mul(std::string a, std::string b) {
   int decimalC = decimalA + decimalB;
   int dotC = c.length() - decimalC;
 
-  if (dotC > 0) c.insert(dotC, 1, '.');
+  if (dotC <= 0) {
+    c.insert(0, 1 - dotC, '0');
+    dotC = 1;
+  }
+  c.insert(dotC, 1, '.');
   trim(c);
 
   return c;
@@ -285,7 +881,7 @@ std::string BigNum::mul(std::string a, std::string b) {
  *          Helper function for div
  * @param a First string
  * @param b Second string
- * @return Average of a and b
+ * @return Average of a and b, rounded down
  * @todo Support decimal numbers
 */
 std::string BigNum::avg(const std::string &a, const std::string &b) {
@@ -294,20 +890,8 @@ std::string BigNum::avg(const std::string &a, const std::string &b) {
     return std::to_string((std::stoll(a) + std::stoll(b)) >> 1);
   }
 
-  // String addition
-  std::string sum = add(a, b);
-  std::string c = sum;
-
-  // Divide by 2
-  int carry = 0;
-  for (int i = 0; i < sum.length(); ++i) {
-    int digit = sum[i] - '0';
-    c[i] = (char)(((digit + carry * 10) >> 1) + '0');
-    carry = (digit + carry * 10) & 1;
-  }
-  trim(c);
-
-  return c;
+  // Shift the sum right by one bit
+  return shr(add(a, b), 1);
 }
 
 /**
@@ -350,4 +934,444 @@ std::string BigNum::div(const std::string &a, const std::string &b) {
   while (mul(m, b).length() > a.length() || (mul(m, b).length() == a.length() && mul(m, b) > a)) m = sub(m, "1");
 
   return m;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Multiply a string by a power of two
+ * @details Assume a is a non-negative integer and k is non-negative
+ *          Multiplies the base 10 ^ 9 chunks by up to 2 ^ 32 per pass, so the
+ *          cost is linear in the length of a per 32 bits of shift
+ * @param a String
+ * @param k Number of bits
+ * @return a * 2 ^ k
+*/
+std::string BigNum::shl(const std::string &a, long long k) {
+  std::vector<uint32_t> c = to_chunks(a);
+  if (c.empty()) return "0";
+
+  for (; k > 0; k -= 32) {
+    int bits = k < 32 ? k : 32;
+    uint64_t carry = 0;
+    for (uint32_t &chunk : c) {
+      uint64_t v = ((uint64_t)chunk << bits) + carry;
+      chunk = v % CHUNK;
+      carry = v / CHUNK;
+    }
+    for (; carry; carry /= CHUNK) c.push_back(carry % CHUNK);
+  }
+  return from_chunks(c);
+}
+
+/**
+ * @brief Divide a string by a power of two
+ * @details Assume a is a non-negative integer and k is non-negative
+ *          Short division of the base 10 ^ 9 chunks by up to 2 ^ 32 per pass
+ * @param a String
+ * @param k Number of bits
+ * @return a / 2 ^ k, rounded down
+*/
+std::string BigNum::shr(const std::string &a, long long k) {
+  // a < 10 ^ length <= 2 ^ (4 * length)
+  if (k >= 4 * (long long)a.length()) return "0";
+  std::vector<uint32_t> c = to_chunks(a);
+
+  for (; k > 0 && !c.empty(); k -= 32) {
+    int bits = k < 32 ? k : 32;
+    uint64_t rem = 0;
+    for (int i = c.size() - 1; i >= 0; --i) {
+      uint64_t v = rem * CHUNK + c[i];
+      c[i] = (uint32_t)(v >> bits);
+      rem = v & ((1ULL << bits) - 1);
+    }
+    while (!c.empty() && c.back() == 0) c.pop_back();
+  }
+  return from_chunks(c);
+}
+
+/**
+ * @brief Convert a string to binary limbs
+ * @details Assume a is a non-negative integer
+ *          Repeated short division by 2 ^ 32, quadratic in the length of a
+ * @param a String
+ * @return Limbs in base 2 ^ 32, least significant first, empty for zero
+*/
+std::vector<uint32_t> BigNum::to_limbs(const std::string &a) {
+  std::vector<uint32_t> c = to_chunks(a), limbs;
+  while (!c.empty()) {
+    uint64_t rem = 0;
+    for (int i = c.size() - 1; i >= 0; --i) {
+      uint64_t v = rem * CHUNK + c[i];
+      c[i] = (uint32_t)(v >> 32);
+      rem = v & 0xFFFFFFFFu;
+    }
+    limbs.push_back((uint32_t)rem);
+    while (!c.empty() && c.back() == 0) c.pop_back();
+  }
+  return limbs;
+}
+
+/**
+ * @brief Convert binary limbs to a string
+ * @details Horner's method in base 10 ^ 9, quadratic in the number of limbs
+ * @param limbs Limbs in base 2 ^ 32, least significant first
+ * @return String
+*/
+std::string BigNum::from_limbs(const std::vector<uint32_t> &limbs) {
+  std::vector<uint32_t> c;
+  for (int i = limbs.size() - 1; i >= 0; --i) {
+    uint64_t carry = limbs[i];
+    for (uint32_t &chunk : c) {
+      uint64_t v = ((uint64_t)chunk << 32) + carry;
+      chunk = v % CHUNK;
+      carry = v / CHUNK;
+    }
+    for (; carry; carry /= CHUNK) c.push_back(carry % CHUNK);
+  }
+  return from_chunks(c);
+}
+
+/**
+ * @brief Bitwise operation in two's complement
+ * @details Both operands are sign-extended to a common width, combined limb
+ *          by limb, and the result is read back as two's complement
+ * @param bn Second operand
+ * @param op One of '&', '|', '^'
+ * @return *this op bn
+ * @throws Decimal number
+*/
+BigNum BigNum::bitwise(const BigNum &bn, const char &op) const {
+  check_integer(*this);
+  check_integer(bn);
+  // Negative x is stored as the complement of |x| - 1
+  std::vector<uint32_t> a = to_limbs(this->sign ? this->num : sub(this->num, "1"));
+  std::vector<uint32_t> b = to_limbs(bn.sign ? bn.num : sub(bn.num, "1"));
+  size_t n = (a.size() > b.size() ? a.size() : b.size()) + 1;
+  a.resize(n, 0);
+  b.resize(n, 0);
+  uint32_t maskA = this->sign ? 0 : 0xFFFFFFFFu, maskB = bn.sign ? 0 : 0xFFFFFFFFu;
+
+  std::vector<uint32_t> c(n);
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t x = a[i] ^ maskA, y = b[i] ^ maskB;
+    c[i] = op == '&' ? x & y : op == '|' ? x | y : x ^ y;
+  }
+
+  if (!(c.back() & 0x80000000u)) return BigNum(true, from_limbs(c));
+  for (uint32_t &limb : c) limb = ~limb;
+  return BigNum(false, add(from_limbs(c), "1"));
+}
+
+
+////////// Output-parameter arithmetic //////////
+
+static const uint32_t POW10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// Per-thread limb buffers; their capacity persists across calls
+struct Scratch {
+  std::vector<uint32_t> x, y, z, w, out;
+};
+static thread_local Scratch scratch;
+
+/**
+ * @brief Number of digits after the decimal point
+*/
+static int frac_digits(const std::string &s) {
+  size_t dot = s.find_first_of('.');
+  return dot == std::string::npos ? 0 : s.length() - dot - 1;
+}
+
+/**
+ * @brief Significant limbs, ignoring leading zero limbs
+*/
+static size_t top(const std::vector<uint32_t> &x) {
+  size_t n = x.size();
+  while (n > 0 && x[n - 1] == 0) --n;
+  return n;
+}
+
+/**
+ * @brief Load a string as base 10 ^ 9 limbs scaled to a fixed number of decimals
+ * @param s String
+ * @param scale Number of decimals
+ * @param out Output limbs of s * 10 ^ scale, least significant first
+ * @throws Decimal number if s has more decimals than scale
+*/
+static void load(const std::string &s, const int &scale, std::vector<uint32_t> &out) {
+  int frac = frac_digits(s);
+  if (frac > scale) throw "Decimal number";
+  size_t pos = scale - frac;
+  size_t digits = pos + s.length();
+  out.assign((digits + 8) / 9, 0);
+  for (size_t i = s.length(); i-- > 0;) {
+    if (s[i] == '.') continue;
+    out[pos / 9] += (s[i] - '0') * POW10[pos % 9];
+    ++pos;
+  }
+  out.resize(top(out));
+}
+
+/**
+ * @brief Store limbs scaled by 10 ^ scale into a BigNum
+ * @details Writes the digits into the existing string of r, so its capacity
+ *          is reused, and normalizes the result like trim
+ * @param x Limbs, least significant first
+ * @param scale Number of decimals
+ * @param sign Sign of the result
+ * @param r Output
+*/
+static void store(const std::vector<uint32_t> &x, const int &scale, const bool &sign, BigNum &r) {
+  size_t n = top(x);
+  std::string &s = r.num.edit();
+  r.sign = sign || n == 0;
+  if (n == 0) {
+    s.assign(1, '0');
+    r.num.sync();
+    return;
+  }
+
+  size_t digits = 9 * (n - 1);
+  for (uint32_t t = x[n - 1]; t; t /= 10) ++digits;
+  size_t total = digits > (size_t)scale ? digits : scale;
+  s.resize(total + (scale > 0));
+  size_t p = s.length();
+  for (size_t k = 0; k < total; ++k) {
+    if (scale > 0 && k == (size_t)scale) s[--p] = '.';
+    s[--p] = k < 9 * n ? (char)(x[k / 9] / POW10[k % 9] % 10 + '0') : '0';
+  }
+  if (scale > 0 && total == (size_t)scale) s[--p] = '.';
+
+  // Remove trailing zeros of the decimal part
+  if (scale > 0) {
+    s.resize(s.find_last_not_of('0') + 1);
+    if (s.back() == '.') s.pop_back();
+  }
+  r.num.sync();
+}
+
+/**
+ * @brief Compare magnitudes of limbs
+ * @return Negative, zero or positive as x < y, x == y or x > y
+*/
+static int compare(const std::vector<uint32_t> &x, const std::vector<uint32_t> &y) {
+  size_t n = top(x), m = top(y);
+  if (n != m) return n < m ? -1 : 1;
+  for (size_t i = n; i-- > 0;) {
+    if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Product of limbs
+ * @details Schoolbook into the existing capacity of out while the shorter
+ *          operand is below KARATSUBA_LIMBS, Karatsuba above
+ * @param x First magnitude
+ * @param y Second magnitude
+ * @param out Output magnitude
+*/
+static void product(const std::vector<uint32_t> &x, const std::vector<uint32_t> &y, std::vector<uint32_t> &out) {
+  if (std::min(x.size(), y.size()) < KARATSUBA_LIMBS) mul_limbs(x, y, out);
+  else out = mul_karatsuba(x, y);
+}
+
+/**
+ * @brief Signed sum of limbs
+ * @param x First magnitude
+ * @param sx Sign of x
+ * @param y Second magnitude
+ * @param sy Sign of y
+ * @param out Output magnitude
+ * @return Sign of the sum
+*/
+static bool signed_add(const std::vector<uint32_t> &x, const bool &sx, const std::vector<uint32_t> &y, const bool &sy, std::vector<uint32_t> &out) {
+  if (sx == sy) {
+    const std::vector<uint32_t> &l = x.size() >= y.size() ? x : y, &s = x.size() >= y.size() ? y : x;
+    out.resize(l.size() + 1);
+    uint32_t carry = 0;
+    for (size_t i = 0; i < l.size(); ++i) {
+      uint32_t v = l[i] + (i < s.size() ? s[i] : 0) + carry;
+      carry = v >= CHUNK;
+      out[i] = carry ? v - CHUNK : v;
+    }
+    out[l.size()] = carry;
+    return sx;
+  }
+
+  // Subtract the smaller magnitude from the larger one
+  bool swap = compare(x, y) < 0;
+  const std::vector<uint32_t> &l = swap ? y : x, &s = swap ? x : y;
+  out.resize(l.size());
+  uint32_t borrow = 0;
+  for (size_t i = 0; i < l.size(); ++i) {
+    uint32_t d = (i < s.size() ? s[i] : 0) + borrow;
+    borrow = l[i] < d;
+    out[i] = borrow ? l[i] + CHUNK - d : l[i] - d;
+  }
+  return swap ? sy : sx;
+}
+
+/**
+ * @brief r = a + b
+ * @details Works on base 10 ^ 9 limbs in per-thread buffers and writes the
+ *          digits into the existing storage of r
+*/
+void add(BigNum &r, const BigNum &a, const BigNum &b) {
+  int fa = frac_digits(a.num), fb = frac_digits(b.num), scale = fa > fb ? fa : fb;
+  load(a.num, scale, scratch.x);
+  load(b.num, scale, scratch.y);
+  bool sign = signed_add(scratch.x, a.sign, scratch.y, b.sign, scratch.out);
+  store(scratch.out, scale, sign, r);
+}
+
+/**
+ * @brief r = a - b
+*/
+void sub(BigNum &r, const BigNum &a, const BigNum &b) {
+  int fa = frac_digits(a.num), fb = frac_digits(b.num), scale = fa > fb ? fa : fb;
+  load(a.num, scale, scratch.x);
+  load(b.num, scale, scratch.y);
+  bool sign = signed_add(scratch.x, a.sign, scratch.y, !b.sign, scratch.out);
+  store(scratch.out, scale, sign, r);
+}
+
+/**
+ * @brief r = a * b
+ * @details Product on base 10 ^ 9 limbs, Karatsuba for long operands
+*/
+void mul(BigNum &r, const BigNum &a, const BigNum &b) {
+  int fa = frac_digits(a.num), fb = frac_digits(b.num);
+  load(a.num, fa, scratch.x);
+  load(b.num, fb, scratch.y);
+  product(scratch.x, scratch.y, scratch.out);
+  store(scratch.out, fa + fb, a.sign == b.sign, r);
+}
+
+/**
+ * @brief Multiply and add
+ * @details a is scaled so that a * b has as many decimals as r
+ * @param r Accumulator, r = r + a * b
+*/
+static void muladd(BigNum &r, const BigNum &a, const BigNum &b, const bool &sign) {
+  int fa = frac_digits(a.num), fb = frac_digits(b.num), fr = frac_digits(r.num);
+  int scale = fa + fb > fr ? fa + fb : fr;
+  load(a.num, scale - fb, scratch.x);
+  load(b.num, fb, scratch.y);
+  load(r.num, scale, scratch.w);
+  product(scratch.x, scratch.y, scratch.z);
+  bool res = signed_add(scratch.w, r.sign, scratch.z, sign, scratch.out);
+  store(scratch.out, scale, res, r);
+}
+
+/**
+ * @brief r = r + a * b
+*/
+void addmul(BigNum &r, const BigNum &a, const BigNum &b) { muladd(r, a, b, a.sign == b.sign); }
+
+/**
+ * @brief r = r - a * b
+*/
+void submul(BigNum &r, const BigNum &a, const BigNum &b) { muladd(r, a, b, a.sign != b.sign); }
+
+/**
+ * @brief Quotient and remainder
+ * @details Assume a, b are integers
+ *          Long division on base 10 ^ 9 limbs (Knuth's algorithm D). Like
+ *          operator/, the quotient truncates toward zero and the remainder
+ *          takes the sign of a.
+ * @param q Output quotient
+ * @param r Output remainder, distinct from q
+ * @param a Dividend
+ * @param b Divisor
+ * @throws Division by zero, Aliased outputs, Decimal number
+ * @see https://en.wikipedia.org/wiki/Division_algorithm#Long_division
+*/
+void divmod(BigNum &q, BigNum &r, const BigNum &a, const BigNum &b) {
+  if (&q == &r) throw "Aliased outputs";
+  std::vector<uint32_t> &u = scratch.x, &v = scratch.y, &quot = scratch.z, &rem = scratch.out;
+  load(a.num, 0, u);
+  load(b.num, 0, v);
+  if (v.empty()) throw "Division by zero";
+  bool qs = a.sign == b.sign, rs = a.sign;
+
+  size_t n = v.size();
+  if (compare(u, v) < 0) {
+    quot.clear();
+    rem.assign(u.begin(), u.end());
+  } else if (n == 1) {
+    // Short division
+    quot.assign(u.size(), 0);
+    uint64_t carry = 0;
+    for (size_t i = u.size(); i-- > 0;) {
+      uint64_t t = carry * CHUNK + u[i];
+      quot[i] = t / v[0];
+      carry = t % v[0];
+    }
+    rem.assign(1, carry);
+  } else {
+    // Normalize so that the top limb of v is at least CHUNK / 2
+    size_t m = u.size() - n;
+    uint32_t d = CHUNK / (v[n - 1] + 1);
+    u.push_back(0);
+    if (d > 1) {
+      uint64_t carry = 0;
+      for (uint32_t &limb : u) {
+        uint64_t t = (uint64_t)limb * d + carry;
+        limb = t % CHUNK;
+        carry = t / CHUNK;
+      }
+      carry = 0;
+      for (uint32_t &limb : v) {
+        uint64_t t = (uint64_t)limb * d + carry;
+        limb = t % CHUNK;
+        carry = t / CHUNK;
+      }
+    }
+
+    quot.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+      // Estimate the quotient limb from the top two limbs, then correct it
+      uint64_t num = (uint64_t)u[j + n] * CHUNK + u[j + n - 1];
+      uint64_t qhat = num / v[n - 1], rhat = num % v[n - 1];
+      while (qhat >= CHUNK || qhat * v[n - 2] > rhat * CHUNK + u[j + n - 2]) {
+        --qhat;
+        rhat += v[n - 1];
+        if (rhat >= CHUNK) break;
+      }
+
+      // u[j..j+n] -= qhat * v
+      uint64_t carry = 0;
+      int64_t borrow = 0;
+      for (size_t i = 0; i <= n; ++i) {
+        uint64_t p = (i < n ? qhat * v[i] : 0) + carry;
+        carry = p / CHUNK;
+        int64_t t = (int64_t)u[i + j] - (int64_t)(p % CHUNK) - borrow;
+        borrow = t < 0;
+        u[i + j] = borrow ? t + CHUNK : t;
+      }
+
+      // The estimate was one too large; add v back
+      if (borrow) {
+        --qhat;
+        uint32_t c = 0;
+        for (size_t i = 0; i <= n; ++i) {
+          uint32_t t = u[i + j] + (i < n ? v[i] : 0) + c;
+          c = t >= CHUNK;
+          u[i + j] = c ? t - CHUNK : t;
+        }
+      }
+      quot[j] = qhat;
+    }
+
+    // Undo the normalization of the remainder
+    rem.assign(n, 0);
+    uint64_t carry = 0;
+    for (size_t i = n; i-- > 0;) {
+      uint64_t t = carry * CHUNK + u[i];
+      rem[i] = t / d;
+      carry = t % d;
+    }
+  }
+
+  store(quot, 0, qs, q);
+  store(rem, 0, rs, r);
+}
@@ -1,70 +1,162 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
+
+// Immutable digit string shared between copies, copied on the first edit
+// Copies only share the digits; a moved-from object may only be assigned or destroyed
+class BigNumDigits {
+public:
+  // Constructors
+  explicit BigNumDigits(std::string s);
+  BigNumDigits(const BigNumDigits &d) = default;
+  BigNumDigits(BigNumDigits &&d) = default;
+
+  // Assignment operators
+  BigNumDigits &operator=(const BigNumDigits &d) = default;
+  BigNumDigits &operator=(BigNumDigits &&d) = default;
+  BigNumDigits &operator=(std::string s);
+
+  // Access
+  operator const std::string &(void) const;
+  const std::string &str(void) const;
+  std::string &edit(void);
+  void sync(void);
+  long use_count(void) const;
+  size_t point(void) const;
+
+  // Read-only string operations
+  size_t length(void) const;
+  size_t size(void) const;
+  bool empty(void) const;
+  const char &operator[](const size_t &i) const;
+  const char &front(void) const;
+  const char &back(void) const;
+  const char *c_str(void) const;
+  std::string::const_iterator begin(void) const;
+  std::string::const_iterator end(void) const;
+  std::string substr(const size_t &pos = 0, const size_t &n = std::string::npos) const;
+  size_t find_first_of(const char &c, const size_t &pos = 0) const;
+  size_t find_first_of(const char *chars, const size_t &pos = 0) const;
+  size_t find_first_not_of(const char &c, const size_t &pos = 0) const;
+  size_t find_first_not_of(const char *chars, const size_t &pos = 0) const;
+  size_t find_last_not_of(const char &c, const size_t &pos = std::string::npos) const;
+  size_t find_last_not_of(const char *chars, const size_t &pos = std::string::npos) const;
+
+private:
+  static const size_t STALE = std::string::npos - 1;
+
+  std::shared_ptr<std::string> data; // reference counted atomically, never edited while shared
+  size_t dot;                        // index of the decimal point, npos if none, STALE after edit()
+};
+
+// Comparison and concatenation with plain strings
+bool operator==(const BigNumDigits &a, const BigNumDigits &b);
+bool operator==(const BigNumDigits &a, const std::string &b);
+bool operator==(const BigNumDigits &a, const char *b);
+bool operator!=(const BigNumDigits &a, const BigNumDigits &b);
+bool operator!=(const BigNumDigits &a, const std::string &b);
+bool operator!=(const BigNumDigits &a, const char *b);
+bool operator<(const BigNumDigits &a, const BigNumDigits &b);
+std::string operator+(const BigNumDigits &a, const std::string &b);
+std::string operator+(const std::string &a, const BigNumDigits &b);
+std::ostream &operator<<(std::ostream &os, const BigNumDigits &d);
 
 class BigNum {
 public:
-  std::string num;
+  BigNumDigits num;
   bool sign; // true: '+', false: '-'
 
   // Constructors
   BigNum(void);
-  BigNum(const BigNum &bn);
+  BigNum(const BigNum &bn) = default;
+  BigNum(BigNum &&bn) = default;
   BigNum(const long long &n);
   BigNum(const long double &n);
   BigNum(const std::string &s);
-  BigNum(const bool &s, const std::string &n);
+  BigNum(const bool &s, std::string n);
+  BigNum(const bool &s, const BigNumDigits &n);
 
   // Input & Output
   friend std::istream &operator>>(std::istream &is, BigNum &bn);
   friend std::ostream &operator<<(std::ostream &os, const BigNum &bn);
   
   // Assignment operators
-  BigNum &operator=(const BigNum &bn);
+  BigNum &operator=(const BigNum &bn) = default;
+  BigNum &operator=(BigNum &&bn) = default;
   BigNum &operator=(const long long &n);
   BigNum &operator=(const std::string &s);
 
   // Addition operators
-  BigNum operator+(const BigNum &bn);
-  BigNum operator+(const long long &n);
-  BigNum operator+(const std::string &s);
+  BigNum operator+(const BigNum &bn) const;
+  BigNum operator+(const long long &n) const;
+  BigNum operator+(const std::string &s) const;
   BigNum operator+=(const BigNum &bn);
   BigNum operator+=(const long long &n);
   BigNum operator+=(const std::string &s);
 
   // Subtraction operators
-  BigNum operator-(const BigNum &bn);
-  BigNum operator-(const long long &n);
-  BigNum operator-(const std::string &s);
+  BigNum operator-(const BigNum &bn) const;
+  BigNum operator-(const long long &n) const;
+  BigNum operator-(const std::string &s) const;
   BigNum operator-=(const BigNum &bn);
   BigNum operator-=(const long long &n);
   BigNum operator-=(const std::string &s);
 
   // Multiplication operators
-  BigNum operator*(const BigNum &bn);
-  BigNum operator*(const long long &n);
-  BigNum operator*(const std::string &s);
+  BigNum operator*(const BigNum &bn) const;
+  BigNum operator*(const long long &n) const;
+  BigNum operator*(const std::string &s) const;
   BigNum operator*=(const BigNum &bn);
   BigNum operator*=(const long long &n);
   BigNum operator*=(const std::string &s);
 
   // Division operators
-  BigNum operator/(const BigNum &bn);
-  BigNum operator/(const long long &n);
-  BigNum operator/(const std::string &s);
+  BigNum operator/(const BigNum &bn) const;
+  BigNum operator/(const long long &n) const;
+  BigNum operator/(const std::string &s) const;
   BigNum operator/=(const BigNum &bn);
   BigNum operator/=(const long long &n);
   BigNum operator/=(const std::string &s);
 
   // Modulo operators
-  BigNum operator%(const BigNum &bn);
-  BigNum operator%(const long long &n);
-  BigNum operator%(const std::string &s);
+  BigNum operator%(const BigNum &bn) const;
+  BigNum operator%(const long long &n) const;
+  BigNum operator%(const std::string &s) const;
   BigNum operator%=(const BigNum &bn);
   BigNum operator%=(const long long &n);
   BigNum operator%=(const std::string &s);
 
+  // Shift operators
+  BigNum operator<<(const long long &k) const;
+  BigNum operator>>(const long long &k) const;
+  BigNum operator<<=(const long long &k);
+  BigNum operator>>=(const long long &k);
+
+  // Bitwise operators
+  BigNum operator&(const BigNum &bn) const;
+  BigNum operator&(const long long &n) const;
+  BigNum operator&(const std::string &s) const;
+  BigNum operator&=(const BigNum &bn);
+  BigNum operator&=(const long long &n);
+  BigNum operator&=(const std::string &s);
+  BigNum operator|(const BigNum &bn) const;
+  BigNum operator|(const long long &n) const;
+  BigNum operator|(const std::string &s) const;
+  BigNum operator|=(const BigNum &bn);
+  BigNum operator|=(const long long &n);
+  BigNum operator|=(const std::string &s);
+  BigNum operator^(const BigNum &bn) const;
+  BigNum operator^(const long long &n) const;
+  BigNum operator^(const std::string &s) const;
+  BigNum operator^=(const BigNum &bn);
+  BigNum operator^=(const long long &n);
+  BigNum operator^=(const std::string &s);
+  BigNum operator~(void) const;
+
   // Comparison operators
   bool operator==(const BigNum &bn) const;
   bool operator==(const long long &n) const;
@@ -85,15 +177,49 @@ public:
   bool operator>=(const long long &n) const;
   bool operator>=(const std::string &s) const;
 
+  // Storage
+  void reserve(const size_t &digits);
+  void shrink_to_fit(void);
+  size_t capacity(void) const;
+
+  // Bit queries
+  long long bit_length(void) const;
+  long long popcount(void) const;
+  bool test_bit(const long long &i) const;
+  long long trailing_zeros(void) const;
+
+  // Magnitude queries
+  long long digits10(void) const;
+  std::string leading_digits(const long long &k) const;
+  std::string to_scientific(const int &precision) const;
+  double to_double(void) const;
+  double log2(void) const;
+  double log10(void) const;
+
   // Helper functions
-  void trim(std::string &s);
-  void padding(std::string &a, std::string &b);
+  static void trim(std::string &s);
+  static void padding(std::string &a, std::string &b);
+  static void padding(BigNumDigits &a, BigNumDigits &b);
+  static bool abs_geq(std::string a, std::string b);
 
   // Basic operations
-  std::string add(std::string a, std::string b);
-  std::string sub(std::string a, std::string b);
-  std::string karatsuba(std::string a, std::string b);
-  std::string mul(std::string a, std::string b);
-  std::string avg(const std::string &a, const std::string &b);
-  std::string div(const std::string &a, const std::string &b);
-};
\ No newline at end of file
+  static std::string add(std::string a, std::string b);
+  static std::string sub(std::string a, std::string b);
+  static std::string karatsuba(std::string a, std::string b);
+  static std::string mul(std::string a, std::string b);
+  static std::string avg(const std::string &a, const std::string &b);
+  static std::string div(const std::string &a, const std::string &b);
+  static std::string shl(const std::string &a, long long k);
+  static std::string shr(const std::string &a, long long k);
+  static std::vector<uint32_t> to_limbs(const std::string &a);
+  static std::string from_limbs(const std::vector<uint32_t> &limbs);
+  BigNum bitwise(const BigNum &bn, const char &op) const;
+};
+
+// Arithmetic into an existing BigNum, reusing its storage; r may alias a or b
+void add(BigNum &r, const BigNum &a, const BigNum &b);
+void sub(BigNum &r, const BigNum &a, const BigNum &b);
+void mul(BigNum &r, const BigNum &a, const BigNum &b);
+void addmul(BigNum &r, const BigNum &a, const BigNum &b);
+void submul(BigNum &r, const BigNum &a, const BigNum &b);
+void divmod(BigNum &q, BigNum &r, const BigNum &a, const BigNum &b);
@@ -0,0 +1,236 @@
+#include "BigNumAccumulator.h"
+
+static const int64_t BASE = 1000000000;
+
+// Each addition puts less than 10 ^ 9 into a limb, so a normalized limb
+// can take 9 * 10 ^ 9 of them before an int64_t could overflow
+static const uint64_t LIMIT = 9000000000ULL;
+
+/**
+ * @brief Split a BigNum into base 10 ^ 9 chunks aligned on the decimal point
+ * @param bn Big number
+ * @param frac Output number of chunks after the decimal point
+ * @return Chunks of the magnitude, least significant first
+*/
+static std::vector<int64_t> split(const BigNum &bn, int &frac) {
+  const std::string &s = bn.num;
+  size_t dot = s.find_first_of('.');
+  std::string intPart = dot == std::string::npos ? s : s.substr(0, dot);
+  std::string fracPart = dot == std::string::npos ? "" : s.substr(dot + 1);
+  frac = (fracPart.length() + 8) / 9;
+  fracPart.append(9 * frac - fracPart.length(), '0');
+
+  std::vector<int64_t> c;
+  c.reserve(frac + intPart.length() / 9 + 1);
+  for (int i = frac - 1; i >= 0; --i) c.push_back(std::stoll(fracPart.substr(9 * i, 9)));
+  for (int end = intPart.length(); end > 0; end -= 9) {
+    int64_t chunk = 0;
+    for (int i = end > 9 ? end - 9 : 0; i < end; ++i) chunk = chunk * 10 + (intPart[i] - '0');
+    c.push_back(chunk);
+  }
+  while (!c.empty() && c.back() == 0) c.pop_back();
+  return c;
+}
+
+/**
+ * @brief Split an encoded record into base 10 ^ 9 chunks aligned on the decimal point
+ * @details The record's limbs are aligned on its last digit, so they are
+ *          shifted up to the next multiple of nine decimals in one pass
+ * @param view Encoded record
+ * @param frac Output number of chunks after the decimal point
+ * @return Chunks of the magnitude, least significant first
+ * @throws Invalid limb
+*/
+static std::vector<int64_t> split(const BigNumView &view, int &frac) {
+  frac = (view.scale + 8) / 9;
+  int64_t shift = 1;
+  for (uint32_t i = view.scale; i < 9 * (uint32_t)frac; ++i) shift *= 10;
+
+  std::vector<int64_t> c;
+  c.reserve(view.count + 1);
+  int64_t carry = 0;
+  for (uint32_t i = 0; i < view.count; ++i) {
+    int64_t t = view.limb(i) * shift + carry;
+    c.push_back(t % BASE);
+    carry = t / BASE;
+  }
+  if (carry) c.push_back(carry);
+  while (!c.empty() && c.back() == 0) c.pop_back();
+  return c;
+}
+
+////////// Constructors //////////
+
+BigNumAccumulator::BigNumAccumulator(void) : frac(0), pending(0) {}
+
+////////// Accumulation //////////
+
+BigNumAccumulator &BigNumAccumulator::operator+=(const BigNum &bn) { add(bn); return *this; }
+BigNumAccumulator &BigNumAccumulator::operator-=(const BigNum &bn) { sub(bn); return *this; }
+BigNumAccumulator &BigNumAccumulator::operator+=(const BigNumView &view) { add(view); return *this; }
+BigNumAccumulator &BigNumAccumulator::operator-=(const BigNumView &view) { sub(view); return *this; }
+void BigNumAccumulator::add(const BigNum &bn) { add_chunks(bn, false); }
+void BigNumAccumulator::sub(const BigNum &bn) { add_chunks(bn, true); }
+void BigNumAccumulator::add(const BigNumView &view) { add_chunks(view, false); }
+void BigNumAccumulator::sub(const BigNumView &view) { add_chunks(view, true); }
+void BigNumAccumulator::add_product(const BigNum &a, const BigNum &b) { add_product_chunks(a, b, false); }
+void BigNumAccumulator::sub_product(const BigNum &a, const BigNum &b) { add_product_chunks(a, b, true); }
+
+////////// Result //////////
+
+/**
+ * @brief Current sum
+ * @details Normalizes the buffer, which is the only point where carries
+ *          propagate besides overflow protection
+ * @return Sum of everything accumulated so far
+*/
+BigNum BigNumAccumulator::value(void) {
+  normalize();
+  if (limbs.empty()) return BigNum();
+
+  // A negative total leaves a negative top limb; negate to get the magnitude
+  bool sign = limbs.back() >= 0;
+  std::vector<int64_t> mag = limbs;
+  if (!sign) {
+    BigNumAccumulator neg;
+    neg.frac = frac;
+    for (int64_t limb : limbs) neg.limbs.push_back(-limb);
+    neg.pending = 1;
+    neg.normalize();
+    mag = neg.limbs;
+  }
+
+  std::string s;
+  s.reserve(9 * mag.size() + 1);
+  for (int i = (int)mag.size() - 1; i >= 0; --i) {
+    std::string chunk = std::to_string(mag[i]);
+    if (i != (int)mag.size() - 1 || i < frac) s.append(9 - chunk.length(), '0');
+    s.append(chunk);
+    if (i == frac && frac > 0) s.push_back('.');
+  }
+  if ((int)mag.size() <= frac) s.insert(0, "0." + std::string(9 * (frac - mag.size()), '0'));
+  return BigNum(sign, s);
+}
+
+void BigNumAccumulator::clear(void) {
+  limbs.clear();
+  frac = 0;
+  pending = 0;
+}
+
+////////// Helper functions //////////
+
+/**
+ * @brief Propagate all pending carries
+ * @details Leaves every limb in [0, 10 ^ 9) except the top one, which is in
+ *          (-10 ^ 9, 10 ^ 9) and carries the sign of the total
+*/
+void BigNumAccumulator::normalize(void) {
+  int64_t carry = 0;
+  for (size_t i = 0; i < limbs.size(); ++i) {
+    int64_t v = limbs[i] + carry;
+    carry = v / BASE;
+    v %= BASE;
+    if (v < 0) { v += BASE; --carry; }
+    limbs[i] = v;
+  }
+
+  // Split the final carry into new limbs, rounding down until it fits in the top one
+  while (carry <= -BASE || carry >= BASE) {
+    int64_t v = carry % BASE;
+    carry /= BASE;
+    if (v < 0) { v += BASE; --carry; }
+    limbs.push_back(v);
+  }
+  if (carry) limbs.push_back(carry);
+  while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+  pending = limbs.empty() ? 0 : 1;
+}
+
+/**
+ * @brief Make room for more additions into every limb
+ * @param additions Number of additions about to happen
+*/
+void BigNumAccumulator::reserve(const uint64_t &additions) {
+  if (pending + additions > LIMIT) normalize();
+  pending += additions;
+}
+
+/**
+ * @brief Add the chunks of a number without propagating carries
+ * @param bn Big number
+ * @param negate Subtract instead of add
+*/
+void BigNumAccumulator::add_chunks(const BigNum &bn, const bool &negate) {
+  int f = 0;
+  std::vector<int64_t> c = split(bn, f);
+  add_chunks(c, f, negate == bn.sign);
+}
+
+/**
+ * @brief Add the limbs of an encoded record without decoding it to a BigNum
+ * @param view Encoded record
+ * @param negate Subtract instead of add
+ * @throws Invalid limb
+*/
+void BigNumAccumulator::add_chunks(const BigNumView &view, const bool &negate) {
+  int f = 0;
+  std::vector<int64_t> c = split(view, f);
+  add_chunks(c, f, negate == view.sign);
+}
+
+/**
+ * @brief Add aligned chunks without propagating carries
+ * @param c Chunks of the magnitude, least significant first
+ * @param f Number of chunks after the decimal point
+ * @param minus Subtract instead of add
+*/
+void BigNumAccumulator::add_chunks(const std::vector<int64_t> &c, const int &f, const bool &minus) {
+  if (c.empty()) return;
+  reserve(1);
+
+  // Align the decimal points
+  if (f > frac) {
+    limbs.insert(limbs.begin(), f - frac, 0);
+    frac = f;
+  }
+  size_t offset = frac - f;
+  if (limbs.size() < offset + c.size()) limbs.resize(offset + c.size(), 0);
+
+  for (size_t i = 0; i < c.size(); ++i) limbs[offset + i] += minus ? -c[i] : c[i];
+}
+
+/**
+ * @brief Add the schoolbook product of two numbers without propagating carries
+ * @details Each partial product below 10 ^ 18 is split into a low and a
+ *          high chunk, so a limb receives at most 2 * min(|a|, |b|) chunks
+ * @param a First factor
+ * @param b Second factor
+ * @param negate Subtract instead of add
+*/
+void BigNumAccumulator::add_product_chunks(const BigNum &a, const BigNum &b, const bool &negate) {
+  int fa = 0, fb = 0;
+  std::vector<int64_t> x = split(a, fa), y = split(b, fb);
+  if (x.empty() || y.empty()) return;
+  reserve(2 * (x.size() < y.size() ? x.size() : y.size()));
+
+  int f = fa + fb;
+  if (f > frac) {
+    limbs.insert(limbs.begin(), f - frac, 0);
+    frac = f;
+  }
+  size_t offset = frac - f;
+  if (limbs.size() < offset + x.size() + y.size()) limbs.resize(offset + x.size() + y.size(), 0);
+
+  bool minus = negate == (a.sign == b.sign);
+  for (size_t i = 0; i < x.size(); ++i) {
+    if (x[i] == 0) continue;
+    int64_t *row = &limbs[offset + i];
+    for (size_t j = 0; j < y.size(); ++j) {
+      uint64_t p = (uint64_t)x[i] * (uint64_t)y[j];
+      int64_t lo = p % BASE, hi = p / BASE;
+      if (minus) { row[j] -= lo; row[j + 1] -= hi; }
+      else       { row[j] += lo; row[j + 1] += hi; }
+    }
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BigNum.h"
+#include "BigNumBinary.h"
+
+// Running sum of many BigNums with deferred carry propagation
+class BigNumAccumulator {
+public:
+  std::vector<int64_t> limbs; // base 10 ^ 9, least significant first, carries pending
+  int frac;                   // limbs after the decimal point
+  uint64_t pending;           // bound on the additions into any limb since the last normalize
+
+  // Constructors
+  BigNumAccumulator(void);
+
+  // Accumulation
+  BigNumAccumulator &operator+=(const BigNum &bn);
+  BigNumAccumulator &operator-=(const BigNum &bn);
+  BigNumAccumulator &operator+=(const BigNumView &view);
+  BigNumAccumulator &operator-=(const BigNumView &view);
+  void add(const BigNum &bn);
+  void sub(const BigNum &bn);
+  void add(const BigNumView &view);
+  void sub(const BigNumView &view);
+  void add_product(const BigNum &a, const BigNum &b);
+  void sub_product(const BigNum &a, const BigNum &b);
+
+  // Result
+  BigNum value(void);
+  void clear(void);
+
+  // Helper functions
+  void normalize(void);
+  void reserve(const uint64_t &additions);
+  void add_chunks(const BigNum &bn, const bool &negate);
+  void add_chunks(const BigNumView &view, const bool &negate);
+  void add_chunks(const std::vector<int64_t> &c, const int &f, const bool &minus);
+  void add_product_chunks(const BigNum &a, const BigNum &b, const bool &negate);
+};
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include "BigNumBatch.h"
+#include "BigNumUtils.h"
+
+////////// ThreadPool //////////
+
+// Pool whose task the current thread is running, if any
+static thread_local const ThreadPool *current = nullptr;
+
+/**
+ * @brief Start the worker threads
+ * @param threads Total number of threads including the caller of run, or
+ *                0 for one per core
+*/
+ThreadPool::ThreadPool(unsigned threads) : body(nullptr), generation(0), finished(0), stop(false) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < threads; ++i) queues.emplace_back(new Queue());
+  for (unsigned i = 1; i < threads; ++i) workers.emplace_back(&ThreadPool::loop, this, i);
+}
+
+ThreadPool::~ThreadPool(void) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stop = true;
+  }
+  start.notify_all();
+  for (std::thread &t : workers) t.join();
+}
+
+unsigned ThreadPool::size(void) const { return queues.size(); }
+
+/**
+ * @brief Pool shared by the batch functions by default
+*/
+ThreadPool &ThreadPool::shared(void) {
+  static ThreadPool pool;
+  return pool;
+}
+
+/**
+ * @brief Run a batch of independent tasks
+ * @details Tasks are sorted by estimated cost and dealt to the per-thread
+ *          queues in snake order, most expensive first. Each thread drains
+ *          its own queue from the front and then steals from the back of
+ *          the others, so the cheap tail fills in around the big tasks.
+ *          A run called from inside a task executes its batch inline on the
+ *          calling thread, since every other thread may be busy with the
+ *          outer batch, e.g. parallel_transform over a function calling
+ *          batch_gcd.
+ * @param n Number of tasks
+ * @param cost Estimated cost of task i, e.g. operand digits
+ * @param body Task i
+ * @throws The first exception thrown by any task
+*/
+void ThreadPool::run(size_t n, const std::function<size_t(size_t)> &cost, const std::function<void(size_t)> &body) {
+  if (n == 0) return;
+  if (current) {
+    std::exception_ptr first;
+    for (size_t i = 0; i < n; ++i) {
+      try {
+        body(i);
+      } catch (...) {
+        if (!first) first = std::current_exception();
+      }
+    }
+    if (first) std::rethrow_exception(first);
+    return;
+  }
+  std::lock_guard<std::mutex> runGuard(runLock);
+
+  std::vector<std::pair<size_t, size_t>> order(n);
+  for (size_t i = 0; i < n; ++i) order[i] = std::make_pair(cost(i), i);
+  std::sort(order.begin(), order.end(), [](const std::pair<size_t, size_t> &x, const std::pair<size_t, size_t> &y) { return x.first > y.first; });
+  size_t k = queues.size();
+  for (size_t i = 0; i < n; ++i) {
+    size_t round = i / k, slot = i % k;
+    queues[round % 2 ? k - 1 - slot : slot]->tasks.push_back(order[i].second);
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    this->body = &body;
+    error = nullptr;
+    finished = 0;
+    ++generation;
+  }
+  start.notify_all();
+  work(0);
+
+  std::unique_lock<std::mutex> guard(lock);
+  done.wait(guard, [&] { return finished == queues.size(); });
+  this->body = nullptr;
+  if (error) std::rethrow_exception(error);
+}
+
+/**
+ * @brief Worker thread main loop
+ * @param id Index of the worker's queue
+*/
+void ThreadPool::loop(unsigned id) {
+  unsigned long long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      start.wait(guard, [&] { return stop || generation != seen; });
+      if (stop) return;
+      seen = generation;
+    }
+    work(id);
+  }
+}
+
+/**
+ * @brief Execute tasks until every queue is empty
+ * @param id Index of the thread's own queue
+*/
+void ThreadPool::work(unsigned id) {
+  size_t task;
+  current = this;
+  while (pop(id, task)) {
+    try {
+      (*body)(task);
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!error) error = std::current_exception();
+    }
+  }
+  current = nullptr;
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (++finished == queues.size()) done.notify_all();
+}
+
+/**
+ * @brief Take the next task, stealing if the own queue is empty
+ * @param id Index of the thread's own queue
+ * @param task Output task index
+ * @return Whether a task was found
+*/
+bool ThreadPool::pop(unsigned id, size_t &task) {
+  {
+    Queue &own = *queues[id];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.tasks.empty()) {
+      task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues.size(); ++i) {
+    Queue &victim = *queues[(id + i) % queues.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+////////// Batch operations //////////
+
+/**
+ * @brief Element-wise greatest common divisor
+ * @details Assume a, b are non-negative
+ * @param a First numbers
+ * @param b Second numbers
+ * @param pool Thread pool
+ * @return gcd(a[i], b[i]) for every i
+ * @throws Size mismatch
+*/
+std::vector<BigNum> batch_gcd(const std::vector<BigNum> &a, const std::vector<BigNum> &b, ThreadPool &pool) {
+  if (a.size() != b.size()) throw "Size mismatch";
+  std::vector<BigNum> res(a.size());
+  pool.run(a.size(),
+           [&](size_t i) { return a[i].num.length() + b[i].num.length(); },
+           [&](size_t i) { res[i] = gcd(a[i], b[i]); });
+  return res;
+}
+
+/**
+ * @brief Element-wise modular power
+ * @details Assume exp is non-negative and m is positive
+ *          Cost grows with the exponent length times the modulus length squared
+ * @param base Bases
+ * @param exp Exponents
+ * @param m Moduli
+ * @param pool Thread pool
+ * @return base[i] ^ exp[i] mod m[i] for every i
+ * @throws Size mismatch
+*/
+std::vector<BigNum> batch_powmod(const std::vector<BigNum> &base, const std::vector<BigNum> &exp, const std::vector<BigNum> &m, ThreadPool &pool) {
+  if (base.size() != exp.size() || base.size() != m.size()) throw "Size mismatch";
+  std::vector<BigNum> res(base.size());
+  pool.run(base.size(),
+           [&](size_t i) { return exp[i].num.length() * m[i].num.length() * m[i].num.length(); },
+           [&](size_t i) { res[i] = powmod(base[i], exp[i], m[i]); });
+  return res;
+}
+
+/**
+ * @brief Element-wise quotient and remainder
+ * @param a Dividends
+ * @param b Divisors
+ * @param pool Thread pool
+ * @return (a[i] / b[i], a[i] % b[i]) for every i
+ * @throws Size mismatch, Division by zero
+*/
+std::vector<std::pair<BigNum, BigNum>> batch_divmod(const std::vector<BigNum> &a, const std::vector<BigNum> &b, ThreadPool &pool) {
+  if (a.size() != b.size()) throw "Size mismatch";
+  std::vector<std::pair<BigNum, BigNum>> res(a.size());
+  pool.run(a.size(),
+           [&](size_t i) { return a[i].num.length() * b[i].num.length(); },
+           [&](size_t i) {
+             BigNum q = a[i] / b[i];
+             res[i] = std::make_pair(q, a[i] - q * b[i]);
+           });
+  return res;
+}
+
+/**
+ * @brief Batch GCD by product and remainder trees
+ * @details Assume every n[i] is positive
+ *          Builds the product tree once, then pushes P mod node ^ 2 down the
+ *          tree, so each leaf gets P mod n[i] ^ 2 from a remainder of its
+ *          parent instead of one gcd per pair. Each level runs in parallel.
+ * @param n Numbers
+ * @param pool Thread pool
+ * @return gcd(n[i], product of all n[j] with j != i) for every i
+ * @see https://facthacks.cr.yp.to/batchgcd.html
+*/
+std::vector<BigNum> product_tree_gcd(const std::vector<BigNum> &n, ThreadPool &pool) {
+  if (n.empty()) return std::vector<BigNum>();
+
+  // Product tree, leaves first
+  std::vector<std::vector<BigNum>> tree(1, n);
+  while (tree.back().size() > 1) {
+    const std::vector<BigNum> &below = tree.back();
+    std::vector<BigNum> level((below.size() + 1) / 2);
+    pool.run(level.size(),
+             [&](size_t i) { return below[2 * i].num.length(); },
+             [&](size_t i) { level[i] = 2 * i + 1 < below.size() ? below[2 * i] * below[2 * i + 1] : below[2 * i]; });
+    tree.push_back(level);
+  }
+
+  // Remainder tree, root first
+  std::vector<BigNum> rem = tree.back();
+  for (size_t d = tree.size() - 1; d-- > 0;) {
+    const std::vector<BigNum> &level = tree[d];
+    std::vector<BigNum> next(level.size());
+    pool.run(level.size(),
+             [&](size_t i) { return rem[i / 2].num.length(); },
+             [&](size_t i) { next[i] = rem[i / 2] % (level[i] * level[i]); });
+    rem.swap(next);
+  }
+
+  std::vector<BigNum> res(n.size());
+  pool.run(n.size(),
+           [&](size_t i) { return n[i].num.length(); },
+           [&](size_t i) { res[i] = gcd(rem[i] / n[i], n[i]); });
+  return res;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BigNum.h"
+
+// Work-stealing thread pool for fork-join batches of independent tasks
+class ThreadPool {
+public:
+  // Constructors
+  ThreadPool(unsigned threads = 0);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool(void);
+
+  // Run body(0), ..., body(n - 1) and wait for all of them
+  void run(size_t n, const std::function<size_t(size_t)> &cost, const std::function<void(size_t)> &body);
+  unsigned size(void) const;
+  static ThreadPool &shared(void);
+
+private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Queue>> queues; // queues[0] belongs to the calling thread
+  std::mutex lock, runLock;
+  std::condition_variable start, done;
+  const std::function<void(size_t)> *body;
+  std::exception_ptr error;
+  unsigned long long generation;
+  unsigned finished;
+  bool stop;
+
+  void loop(unsigned id);
+  void work(unsigned id);
+  bool pop(unsigned id, size_t &task);
+};
+
+// Batch operations, element-wise over equally sized inputs
+std::vector<BigNum> batch_gcd(const std::vector<BigNum> &a, const std::vector<BigNum> &b, ThreadPool &pool = ThreadPool::shared());
+std::vector<BigNum> batch_powmod(const std::vector<BigNum> &base, const std::vector<BigNum> &exp, const std::vector<BigNum> &m, ThreadPool &pool = ThreadPool::shared());
+std::vector<std::pair<BigNum, BigNum>> batch_divmod(const std::vector<BigNum> &a, const std::vector<BigNum> &b, ThreadPool &pool = ThreadPool::shared());
+
+// gcd(n[i], product of all other n[j]) for every i, via product and remainder trees
+std::vector<BigNum> product_tree_gcd(const std::vector<BigNum> &n, ThreadPool &pool = ThreadPool::shared());
+
+/**
+ * @brief Apply a function to every number in parallel
+ * @details Tasks are balanced by the number of digits of their input
+ * @param in Inputs
+ * @param f Function from const BigNum & to BigNum, safe to call concurrently
+ * @param pool Thread pool
+ * @return f(in[i]) for every i
+*/
+template <typename F>
+std::vector<BigNum> parallel_transform(const std::vector<BigNum> &in, F f, ThreadPool &pool = ThreadPool::shared()) {
+  std::vector<BigNum> out(in.size());
+  pool.run(in.size(), [&](size_t i) { return in[i].num.length(); }, [&](size_t i) { out[i] = f(in[i]); });
+  return out;
+}
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cstring>
+#include "BigNumBinary.h"
+
+static const char MAGIC[4] = {'B', 'G', 'N', 'M'};
+static const size_t RECORD_HEADER = 12, FILE_HEADER = 16;
+static const uint32_t LIMB_BASE = 1000000000;
+
+// read_binary reads limbs in blocks of this many bytes, so a corrupted count
+// fails on the missing data instead of allocating it up front
+static const size_t READ_BLOCK = 1 << 16;
+
+////////// Helper functions //////////
+
+/**
+ * @brief Read a little-endian 32-bit word
+ * @param p Pointer to four bytes
+ * @return Word
+*/
+static uint32_t load32(const unsigned char *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Write a little-endian 32-bit word
+ * @param p Pointer to four bytes
+ * @param x Word
+*/
+static void store32(unsigned char *p, uint32_t x) {
+  p[0] = (unsigned char)x;
+  p[1] = (unsigned char)(x >> 8);
+  p[2] = (unsigned char)(x >> 16);
+  p[3] = (unsigned char)(x >> 24);
+}
+
+/**
+ * @brief Check the header fields of a record
+ * @param count Number of limbs
+ * @param scale Digits after the decimal point
+ * @param flags Flags
+ * @throws Invalid format, Invalid scale
+*/
+static void check_header(uint32_t count, uint32_t scale, uint32_t flags) {
+  if (flags & ~1u) throw "Invalid format";
+  if (count == 0 ? scale != 0 : scale > 9 * (uint64_t)count + BIGNUM_BINARY_MAX_ZEROS) throw "Invalid scale";
+}
+
+/**
+ * @brief Encode a BigNum as one record
+ * @param bn Big number
+ * @return Bytes of the record
+ * @throws Invalid scale
+*/
+static std::vector<unsigned char> encode(const BigNum &bn) {
+  // Digits without the decimal point
+  const std::string &s = bn.num;
+  size_t dot = s.find_first_of('.');
+  uint32_t scale = dot == std::string::npos ? 0 : s.length() - dot - 1;
+  std::string digits = dot == std::string::npos ? s : s.substr(0, dot) + s.substr(dot + 1);
+  size_t lead = digits.find_first_not_of('0');
+  digits = lead == std::string::npos ? "" : digits.substr(lead);
+
+  uint32_t count = (digits.length() + 8) / 9;
+  check_header(count, scale, 0);
+  std::vector<unsigned char> out(RECORD_HEADER + 4 * (size_t)count);
+  store32(&out[0], count);
+  store32(&out[4], scale);
+  store32(&out[8], bn.sign ? 0 : 1);
+
+  // Nine digits per limb, least significant first
+  unsigned char *p = &out[RECORD_HEADER];
+  for (int end = digits.length(); end > 0; end -= 9, p += 4) {
+    uint32_t limb = 0;
+    for (int i = end > 9 ? end - 9 : 0; i < end; ++i) limb = limb * 10 + (digits[i] - '0');
+    store32(p, limb);
+  }
+  return out;
+}
+
+/**
+ * @brief Decode limbs back into a BigNum
+ * @details Assume the header fields passed check_header
+ * @param sign Sign
+ * @param scale Digits after the decimal point
+ * @param count Number of limbs
+ * @param limbs Pointer to the limbs
+ * @return Big number
+ * @throws Invalid limb
+*/
+static BigNum decode(bool sign, uint32_t scale, uint32_t count, const unsigned char *limbs) {
+  std::string s;
+  s.reserve(9 * (size_t)count + 2);
+  for (uint32_t i = count; i-- > 0;) {
+    uint32_t limb = load32(limbs + 4 * (size_t)i);
+    if (limb >= LIMB_BASE || (limb == 0 && i + 1 == count)) throw "Invalid limb";
+    std::string chunk = std::to_string(limb);
+    if (i + 1 != count) s.append(9 - chunk.length(), '0');
+    s.append(chunk);
+  }
+  if (s.empty()) s = "0";
+
+  if (scale) {
+    if (s.length() <= scale) s.insert(0, scale - s.length() + 1, '0');
+    s.insert(s.length() - scale, 1, '.');
+  }
+  return BigNum(sign, s);
+}
+
+/**
+ * @brief Read exactly n bytes from a stream
+ * @throws Truncated data
+*/
+static void read_exact(std::istream &is, unsigned char *p, size_t n) {
+  if (n && !is.read(reinterpret_cast<char *>(p), n)) throw "Truncated data";
+}
+
+////////// Writers and readers //////////
+
+/**
+ * @brief Size of the encoded record
+ * @param bn Big number
+ * @return Number of bytes write_binary produces for bn
+*/
+size_t binary_size(const BigNum &bn) {
+  size_t digits = 0;
+  for (char ch : bn.num) digits += ch != '.';
+  size_t lead = bn.num.find_first_not_of("0.");
+  if (lead == std::string::npos) return RECORD_HEADER;
+  for (size_t i = 0; i < lead; ++i) digits -= bn.num[i] == '0';
+  return RECORD_HEADER + 4 * ((digits + 8) / 9);
+}
+
+/**
+ * @brief Write one record
+ * @param os Output stream, opened in binary mode
+ * @param bn Big number
+ * @throws Invalid scale
+*/
+void write_binary(std::ostream &os, const BigNum &bn) {
+  std::vector<unsigned char> out = encode(bn);
+  os.write(reinterpret_cast<const char *>(out.data()), out.size());
+}
+
+/**
+ * @brief Write a file header followed by one record per number
+ * @param os Output stream, opened in binary mode
+ * @param bns Big numbers
+ * @throws Invalid scale
+*/
+void write_binary(std::ostream &os, const std::vector<BigNum> &bns) {
+  unsigned char header[FILE_HEADER];
+  std::memcpy(header, MAGIC, 4);
+  store32(header + 4, BIGNUM_BINARY_VERSION);
+  store32(header + 8, (uint32_t)((uint64_t)bns.size()));
+  store32(header + 12, (uint32_t)((uint64_t)bns.size() >> 32));
+  os.write(reinterpret_cast<const char *>(header), FILE_HEADER);
+  for (const BigNum &bn : bns) write_binary(os, bn);
+}
+
+/**
+ * @brief Read one record
+ * @details Memory grows with the bytes actually read, never with the count
+ *          field alone
+ * @param is Input stream, opened in binary mode
+ * @return Big number
+ * @throws Truncated data, Invalid format, Invalid scale, Invalid limb
+*/
+BigNum read_binary(std::istream &is) {
+  unsigned char header[RECORD_HEADER];
+  read_exact(is, header, RECORD_HEADER);
+  uint32_t count = load32(header), scale = load32(header + 4), flags = load32(header + 8);
+  check_header(count, scale, flags);
+
+  std::vector<unsigned char> limbs;
+  for (size_t total = 4 * (size_t)count; limbs.size() < total;) {
+    size_t have = limbs.size(), n = std::min(total - have, READ_BLOCK);
+    limbs.resize(have + n);
+    read_exact(is, limbs.data() + have, n);
+  }
+  return decode(!(flags & 1), scale, count, limbs.data());
+}
+
+/**
+ * @brief Read a file header and all of its records
+ * @param is Input stream, opened in binary mode
+ * @return Big numbers
+ * @throws Invalid format, Unsupported version, Truncated data, Invalid scale, Invalid limb
+*/
+std::vector<BigNum> read_binary_vector(std::istream &is) {
+  unsigned char header[FILE_HEADER];
+  read_exact(is, header, FILE_HEADER);
+  if (std::memcmp(header, MAGIC, 4) != 0) throw "Invalid format";
+  if (load32(header + 4) != BIGNUM_BINARY_VERSION) throw "Unsupported version";
+  uint64_t count = load32(header + 8) | (uint64_t)load32(header + 12) << 32;
+
+  std::vector<BigNum> bns;
+  for (uint64_t i = 0; i < count; ++i) bns.push_back(read_binary(is));
+  return bns;
+}
+
+////////// BigNumView //////////
+
+/**
+ * @brief View a record in place
+ * @details Only the 12-byte header and the top limb are read; the other
+ *          limbs are read and checked on access
+ * @param data Start of the record
+ * @param size Bytes available from data
+ * @throws Truncated data, Invalid format, Invalid scale, Invalid limb
+*/
+BigNumView::BigNumView(const unsigned char *data, const size_t &size) : data(data) {
+  if (size < RECORD_HEADER) throw "Truncated data";
+  count = load32(data);
+  scale = load32(data + 4);
+  uint32_t flags = load32(data + 8);
+  check_header(count, scale, flags);
+  sign = !(flags & 1);
+  if ((size - RECORD_HEADER) / 4 < count) throw "Truncated data";
+  // A zero top limb would make compare rank the record by its count
+  if (count && limb(count - 1) == 0) throw "Invalid limb";
+}
+
+/**
+ * @brief Limb i, least significant first
+ * @param i Index
+ * @return Limb in [0, 10 ^ 9)
+ * @throws Invalid limb
+*/
+uint32_t BigNumView::limb(const uint32_t &i) const {
+  uint32_t x = load32(data + RECORD_HEADER + 4 * (size_t)i);
+  if (x >= LIMB_BASE) throw "Invalid limb";
+  return x;
+}
+
+size_t BigNumView::size_bytes(void) const { return RECORD_HEADER + 4 * (size_t)count; }
+BigNum BigNumView::to_bignum(void) const { return decode(sign, scale, count, data + RECORD_HEADER); }
+
+/**
+ * @brief Three-way comparison without decoding
+ * @details Magnitudes with equal scale compare limb by limb from the top;
+ *          otherwise the limbs of the smaller scale are aligned digit by
+ *          digit on the fly
+ * @param view Other view
+ * @return Negative, zero or positive as *this is less, equal or greater
+*/
+int BigNumView::compare(const BigNumView &view) const {
+  bool zeroA = count == 0, zeroB = view.count == 0;
+  if (zeroA && zeroB) return 0;
+  bool signA = sign || zeroA, signB = view.sign || zeroB;
+  if (signA != signB) return signA ? 1 : -1;
+
+  // Compare magnitudes as digit sequences aligned on the decimal point
+  int mag = 0;
+  if (scale == view.scale) {
+    if (count != view.count) mag = count < view.count ? -1 : 1;
+    for (uint32_t i = count; !mag && i-- > 0;) {
+      uint32_t x = limb(i), y = view.limb(i);
+      if (x != y) mag = x < y ? -1 : 1;
+    }
+  } else {
+    // Digit i counts from the least significant digit at the common scale
+    uint32_t common = scale > view.scale ? scale : view.scale;
+    auto digit = [](const BigNumView &v, uint32_t shift, long long i) {
+      long long j = i - shift;
+      if (j < 0 || j >= 9LL * v.count) return 0u;
+      uint32_t x = v.limb(j / 9);
+      for (long long k = j % 9; k > 0; --k) x /= 10;
+      return x % 10;
+    };
+    long long len = 9LL * (count > view.count ? count : view.count) + common;
+    for (long long i = len; !mag && i-- > 0;) {
+      uint32_t x = digit(*this, common - scale, i), y = digit(view, common - view.scale, i);
+      if (x != y) mag = x < y ? -1 : 1;
+    }
+  }
+  return signA ? mag : -mag;
+}
+
+bool BigNumView::operator==(const BigNumView &view) const { return compare(view) == 0; }
+bool BigNumView::operator!=(const BigNumView &view) const { return compare(view) != 0; }
+bool BigNumView::operator<(const BigNumView &view) const { return compare(view) < 0; }
+bool BigNumView::operator<=(const BigNumView &view) const { return compare(view) <= 0; }
+bool BigNumView::operator>(const BigNumView &view) const { return compare(view) > 0; }
+bool BigNumView::operator>=(const BigNumView &view) const { return compare(view) >= 0; }
+
+////////// BigNumArrayView //////////
+
+/**
+ * @brief View a whole file in place
+ * @details Walks the record headers once to index them; no limb is copied
+ * @param data Start of the file, e.g. a memory-mapped region
+ * @param bytes Size of the file
+ * @throws Invalid format, Unsupported version, Truncated data, Invalid scale, Invalid limb
+*/
+BigNumArrayView::BigNumArrayView(const unsigned char *data, const size_t &bytes) : data(data), bytes(bytes) {
+  if (bytes < FILE_HEADER) throw "Truncated data";
+  if (std::memcmp(data, MAGIC, 4) != 0) throw "Invalid format";
+  if (load32(data + 4) != BIGNUM_BINARY_VERSION) throw "Unsupported version";
+  uint64_t count = load32(data + 8) | (uint64_t)load32(data + 12) << 32;
+  if ((bytes - FILE_HEADER) / RECORD_HEADER < count) throw "Truncated data";
+
+  offsets.reserve(count);
+  size_t offset = FILE_HEADER;
+  for (uint64_t i = 0; i < count; ++i) {
+    offsets.push_back(offset);
+    offset += BigNumView(data + offset, bytes - offset).size_bytes();
+  }
+}
+
+size_t BigNumArrayView::size(void) const { return offsets.size(); }
+BigNumView BigNumArrayView::operator[](const size_t &i) const { return BigNumView(data + offsets[i], bytes - offsets[i]); }
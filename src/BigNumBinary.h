@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "BigNum.h"
+
+/*
+ * Binary format, all fields little-endian
+ *
+ * File:   "BGNM" | uint32 version | uint64 count | count records
+ * Record: uint32 limbs | uint32 scale | uint32 flags | limbs * uint32
+ *
+ * Limbs hold the decimal digits, with the decimal point removed, in base
+ * 10 ^ 9, least significant first, so converting to and from a BigNum is
+ * linear. scale is the number of digits after the decimal point and bit 0
+ * of flags is set for negative numbers. Every field is a 4-byte word, so
+ * limbs stay 4-byte aligned in a file mapped at an aligned address.
+ *
+ * Readers reject records with a limb of 10 ^ 9 or more, a top limb of 0,
+ * unknown flags, a scale on zero, or a scale more than
+ * BIGNUM_BINARY_MAX_ZEROS past the digits of the limbs, which bounds the
+ * leading zeros a record can expand to.
+*/
+const uint32_t BIGNUM_BINARY_VERSION = 1;
+const uint32_t BIGNUM_BINARY_MAX_ZEROS = 1 << 24;
+
+// Writers and readers
+size_t binary_size(const BigNum &bn);
+void write_binary(std::ostream &os, const BigNum &bn);
+void write_binary(std::ostream &os, const std::vector<BigNum> &bns);
+BigNum read_binary(std::istream &is);
+std::vector<BigNum> read_binary_vector(std::istream &is);
+
+// Read-only view of one encoded record, e.g. inside a memory-mapped file
+class BigNumView {
+public:
+  const unsigned char *data; // start of the record
+  uint32_t count;            // number of limbs
+  uint32_t scale;            // digits after the decimal point
+  bool sign;                 // true: '+', false: '-'
+
+  // Constructors
+  BigNumView(const unsigned char *data, const size_t &size);
+
+  // Accessors
+  uint32_t limb(const uint32_t &i) const;
+  size_t size_bytes(void) const;
+  BigNum to_bignum(void) const;
+
+  // Comparison operators
+  int compare(const BigNumView &view) const;
+  bool operator==(const BigNumView &view) const;
+  bool operator!=(const BigNumView &view) const;
+  bool operator<(const BigNumView &view) const;
+  bool operator<=(const BigNumView &view) const;
+  bool operator>(const BigNumView &view) const;
+  bool operator>=(const BigNumView &view) const;
+};
+
+// Read-only view of a whole encoded file
+class BigNumArrayView {
+public:
+  const unsigned char *data;
+  size_t bytes;
+  std::vector<size_t> offsets; // offset of each record
+
+  // Constructors
+  BigNumArrayView(const unsigned char *data, const size_t &bytes);
+
+  // Accessors
+  size_t size(void) const;
+  BigNumView operator[](const size_t &i) const;
+};
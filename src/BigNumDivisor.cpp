@@ -0,0 +1,209 @@
+#include <cmath>
+#include <cstdlib>
+#include "BigNumDivisor.h"
+
+/**
+ * @brief High 64 bits of a 64 x 64-bit product
+ * @details Portable schoolbook on 32-bit halves
+*/
+static uint64_t mulhi(uint64_t a, uint64_t b) {
+  uint64_t aLo = (uint32_t)a, aHi = a >> 32, bLo = (uint32_t)b, bHi = b >> 32;
+  uint64_t p0 = aLo * bLo, p1 = aLo * bHi, p2 = aHi * bLo, p3 = aHi * bHi;
+  uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
+/**
+ * @brief Drop the lowest k decimal digits
+ * @details Assume x is a non-negative integer
+*/
+static BigNum drop_digits(const BigNum &x, int k) {
+  if ((int)x.num.length() <= k) return BigNum();
+  return BigNum(true, x.num.substr(0, x.num.length() - k));
+}
+
+/**
+ * @brief Reject decimal operands
+ * @details The reciprocals and digit blocks assume integers
+ * @param s Digits of an operand
+ * @throws Decimal number
+*/
+static void check_integer(const std::string &s) {
+  if (s.find('.') != std::string::npos) throw "Decimal number";
+}
+
+////////// Constructors //////////
+
+/**
+ * @brief Precompute the reciprocal of a divisor
+ * @details Divisors below 2 ^ 32 keep floor((2 ^ 64 - 1) / d) for
+ *          multiply-high division of machine words. Larger divisors keep the
+ *          Barrett constant floor(10 ^ 2k / d), found by Newton's iteration
+ *          y = y + y * (10 ^ 2k - d * y) / 10 ^ 2k from a double estimate.
+ * @param divisor Divisor, a non-zero integer
+ * @throws Division by zero, Decimal number
+ * @see https://gmplib.org/~tege/divcnst-pldi94.pdf
+ * @see https://en.wikipedia.org/wiki/Barrett_reduction
+*/
+BigNumDivisor::BigNumDivisor(const BigNum &divisor) : divisor(divisor), digits(divisor.num.length()), small(false), d(0), inv(0) {
+  if (divisor == 0) throw "Division by zero";
+  const std::string &s = divisor.num;
+  check_integer(s);
+
+  if (digits <= 10 && std::stoull(s) <= 0xFFFFFFFFULL) {
+    small = true;
+    d = std::stoull(s);
+    inv = UINT64_MAX / d;
+    return;
+  }
+
+  // Estimate 10 ^ 2k / d = (10 ^ t / top) * 10 ^ k from the top t digits
+  int t = digits < 17 ? digits : 17;
+  double ratio = std::pow(10.0, t) / std::stod(s.substr(0, t));
+  std::string y0 = std::to_string((unsigned long long)(ratio * 1e14));
+  BigNum y(true, digits >= 14 ? y0 + std::string(digits - 14, '0') : y0.substr(0, y0.length() + digits - 14));
+
+  BigNum r(true, "1" + std::string(2 * digits, '0')), dd(true, divisor.num);
+  for (int iter = 0; iter < 64; ++iter) {
+    BigNum e = r - dd * y;
+    BigNum c = y * e;
+    BigNum step(c.sign, drop_digits(BigNum(true, c.num), 2 * digits).num);
+    if (step == 0) break;
+    y += step;
+  }
+
+  // Final correction to the exact floor
+  while (dd * y > r) y -= 1LL;
+  while (dd * (y + 1LL) <= r) y += 1LL;
+  mu = y;
+}
+
+////////// Basic operations //////////
+
+/**
+ * @brief Quotient and remainder
+ * @details Matches BigNum: the quotient truncates toward zero and the
+ *          remainder takes the sign of x
+ * @param x Integer dividend
+ * @return (x / divisor, x % divisor)
+ * @throws Decimal number
+*/
+std::pair<BigNum, BigNum> BigNumDivisor::divmod(const BigNum &x) const {
+  std::string q, r;
+  if (small) {
+    std::pair<std::string, uint64_t> res = divmod_small(x.num);
+    q = res.first;
+    r = std::to_string(res.second);
+  } else {
+    std::pair<std::string, std::string> res = divmod_large(x.num);
+    q = res.first;
+    r = res.second;
+  }
+  return std::make_pair(BigNum(x.sign == divisor.sign, q), BigNum(x.sign, r));
+}
+
+BigNum BigNumDivisor::div(const BigNum &x) const { return divmod(x).first; }
+BigNum BigNumDivisor::mod(const BigNum &x) const { return divmod(x).second; }
+
+/**
+ * @brief Exact divisibility test
+ * @details Single-limb divisors only compute the remainder
+ * @param x Integer dividend
+ * @return Whether divisor divides x
+ * @throws Decimal number
+*/
+bool BigNumDivisor::divides(const BigNum &x) const {
+  if (!small) return mod(x) == 0;
+  check_integer(x.num);
+  uint64_t rem = 0;
+  size_t head = x.num.length() % 9 ? x.num.length() % 9 : 9;
+  for (size_t i = 0; i < x.num.length(); i += (i ? 9 : head)) {
+    uint64_t acc = rem * 1000000000ULL + std::stoull(x.num.substr(i, i ? 9 : head));
+    uint64_t q = mulhi(acc, inv);
+    rem = acc - q * d;
+    while (rem >= d) rem -= d;
+  }
+  return rem == 0;
+}
+
+////////// Helper functions //////////
+
+/**
+ * @brief Short division by a single-limb divisor
+ * @details Assume x is non-negative
+ *          Nine digits at a time; the quotient of each step is estimated
+ *          with one multiply-high by the reciprocal and fixed by at most two
+ *          subtractions, so no hardware division is executed
+ * @param x Dividend
+ * @return Quotient and remainder
+ * @throws Decimal number
+*/
+std::pair<std::string, uint64_t> BigNumDivisor::divmod_small(const std::string &x) const {
+  check_integer(x);
+  std::string q;
+  q.reserve(x.length());
+  uint64_t rem = 0;
+  size_t head = x.length() % 9 ? x.length() % 9 : 9;
+  for (size_t i = 0; i < x.length(); i += (i ? 9 : head)) {
+    size_t len = i ? 9 : head;
+    uint64_t chunk = 0;
+    for (size_t j = i; j < i + len; ++j) chunk = chunk * 10 + (x[j] - '0');
+
+    // rem < d < 2 ^ 32, so acc < 2 ^ 62
+    uint64_t acc = rem * 1000000000ULL + chunk;
+    uint64_t qd = mulhi(acc, inv);
+    rem = acc - qd * d;
+    while (rem >= d) { rem -= d; ++qd; }
+
+    std::string digits = std::to_string(qd);
+    q.append(len - digits.length(), '0');
+    q.append(digits);
+  }
+  return std::make_pair(q, rem);
+}
+
+/**
+ * @brief Barrett reduction
+ * @details Assume 0 <= x < 10 ^ 2k
+ * @param x Dividend
+ * @return Quotient and remainder
+*/
+std::pair<BigNum, BigNum> BigNumDivisor::barrett(BigNum x) const {
+  BigNum dd(true, divisor.num);
+  BigNum q = drop_digits(drop_digits(x, digits - 1) * mu, digits + 1);
+  BigNum r = x - q * dd;
+  while (r >= dd) {
+    r -= dd;
+    q += 1LL;
+  }
+  return std::make_pair(q, r);
+}
+
+/**
+ * @brief Long division by a multi-limb divisor
+ * @details Assume x is non-negative
+ *          Consumes k digits per step, each a Barrett reduction of the
+ *          running remainder followed by the next k digits
+ * @param x Dividend
+ * @return Quotient and remainder
+ * @throws Decimal number
+*/
+std::pair<std::string, std::string> BigNumDivisor::divmod_large(const std::string &x) const {
+  check_integer(x);
+  if ((int)x.length() < 2 * digits) {
+    std::pair<BigNum, BigNum> res = barrett(BigNum(true, x));
+    return std::make_pair(res.first.num, res.second.num);
+  }
+
+  std::string padded = std::string((digits - x.length() % digits) % digits, '0') + x;
+  std::string q, rem = "0";
+  q.reserve(padded.length());
+  for (size_t i = 0; i < padded.length(); i += digits) {
+    std::string block = padded.substr(i, digits);
+    std::pair<BigNum, BigNum> res = barrett(BigNum(true, rem == "0" ? block : rem + block));
+    q.append(digits - res.first.num.length(), '0');
+    q.append(res.first.num);
+    rem = res.second.num;
+  }
+  return std::make_pair(q, rem);
+}
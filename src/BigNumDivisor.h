@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include "BigNum.h"
+
+// Divisor with a precomputed reciprocal for repeated division by the same value
+class BigNumDivisor {
+public:
+  BigNum divisor;
+  int digits;      // number of digits k of |divisor|
+  bool small;      // |divisor| < 2 ^ 32, divided with a machine reciprocal
+  uint64_t d;      // |divisor| when small
+  uint64_t inv;    // floor((2 ^ 64 - 1) / d) when small
+  BigNum mu;       // floor(10 ^ 2k / |divisor|) otherwise
+
+  // Constructors
+  BigNumDivisor(const BigNum &divisor);
+
+  // Basic operations
+  std::pair<BigNum, BigNum> divmod(const BigNum &x) const;
+  BigNum div(const BigNum &x) const;
+  BigNum mod(const BigNum &x) const;
+  bool divides(const BigNum &x) const;
+
+  // Helper functions
+  std::pair<std::string, uint64_t> divmod_small(const std::string &x) const;
+  std::pair<BigNum, BigNum> barrett(BigNum x) const;
+  std::pair<std::string, std::string> divmod_large(const std::string &x) const;
+};
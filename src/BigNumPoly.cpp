@@ -0,0 +1,301 @@
+#include "BigNumPoly.h"
+#include "BigNumAccumulator.h"
+
+// Kronecker substitution pays off once the packed operands pass this many
+// digits; below that the carry-free limb schoolbook is faster than one
+// Karatsuba product plus packing
+static const size_t KRONECKER_THRESHOLD = 1000;
+
+// Up to this many points Horner's rule in an accumulator beats the subproduct
+// tree, whose power series inverses grow coefficients faster than the
+// schoolbook product can pay back
+static const size_t EVAL_THRESHOLD = 1024;
+
+static BigNum neg(const BigNum &x) { return BigNum(!x.sign, x.num); }
+
+/**
+ * @brief Pack integer coefficients into one integer
+ * @details Evaluates the polynomial at 10 ^ w in a single pass with a signed
+ *          borrow, so mixed signs need no separate subtraction. The value has
+ *          the sign of the leading coefficient as long as every |c[i]| is
+ *          below 10 ^ w / 2.
+ * @param c Coefficients, lowest first
+ * @param w Digits per coefficient
+ * @param sign Output sign of the packed value
+ * @return Magnitude of the packed value
+*/
+static std::string pack(const std::vector<BigNum> &c, const int &w, bool &sign) {
+  sign = c.back().sign;
+  std::string s(w * c.size(), '0');
+  int carry = 0;
+  for (size_t i = 0; i < c.size(); ++i) {
+    const std::string &n = c[i].num;
+    bool same = c[i].sign == sign;
+    for (int j = 0; j < w; ++j) {
+      int d = j < (int)n.length() ? n[n.length() - 1 - j] - '0' : 0;
+      int t = carry + (same ? d : -d);
+      carry = t < 0 ? -1 : t / 10;
+      s[s.length() - 1 - (w * i + j)] = (char)(t - 10 * carry + '0');
+    }
+  }
+  return s;
+}
+
+/**
+ * @brief Unpack coefficients from an integer
+ * @details Each w-digit chunk at or above 10 ^ w / 2 stands for a negative
+ *          coefficient and borrows one from the next chunk
+ * @param s Magnitude of the packed value
+ * @param sign Sign of the packed value
+ * @param w Digits per coefficient
+ * @param count Number of coefficients
+ * @return Coefficients, lowest first
+*/
+static std::vector<BigNum> unpack(const std::string &s, const bool &sign, const int &w, const size_t &count) {
+  BigNum base(true, "1" + std::string(w, '0')), half(true, "5" + std::string(w - 1, '0'));
+  std::vector<BigNum> c(count);
+  bool carry = false;
+  for (size_t i = 0; i < count; ++i) {
+    long long end = (long long)s.length() - (long long)w * i, begin = end > w ? end - w : 0;
+    BigNum v(true, end > 0 ? s.substr(begin, end - begin) : "0");
+    if (carry) v += 1LL;
+    carry = v >= half;
+    if (carry) v -= base;
+    c[i] = sign ? v : neg(v);
+  }
+  return c;
+}
+
+////////// Constructors //////////
+
+BigNumPoly::BigNumPoly(void) {}
+BigNumPoly::BigNumPoly(const std::vector<BigNum> &coef) : coef(coef) { trim(); }
+
+////////// Properties //////////
+
+/**
+ * @brief Degree of the polynomial
+ * @return Degree, or -1 for the zero polynomial
+*/
+int BigNumPoly::degree(void) const { return (int)coef.size() - 1; }
+
+BigNum BigNumPoly::operator[](const size_t &i) const { return i < coef.size() ? coef[i] : BigNum(); }
+
+////////// Arithmetic operators //////////
+
+BigNumPoly BigNumPoly::operator+(const BigNumPoly &p) const {
+  std::vector<BigNum> c(coef.size() > p.coef.size() ? coef.size() : p.coef.size());
+  for (size_t i = 0; i < c.size(); ++i) c[i] = (*this)[i] + p[i];
+  return BigNumPoly(c);
+}
+
+BigNumPoly BigNumPoly::operator-(const BigNumPoly &p) const {
+  std::vector<BigNum> c(coef.size() > p.coef.size() ? coef.size() : p.coef.size());
+  for (size_t i = 0; i < c.size(); ++i) c[i] = (*this)[i] - p[i];
+  return BigNumPoly(c);
+}
+
+BigNumPoly BigNumPoly::operator*(const BigNumPoly &p) const {
+  if (coef.empty() || p.coef.empty()) return BigNumPoly();
+  size_t digits = 0;
+  for (const BigNum &x : coef) digits += x.num.length();
+  for (const BigNum &x : p.coef) digits += x.num.length();
+  return digits < KRONECKER_THRESHOLD ? mul_naive(p) : mul_kronecker(p);
+}
+
+BigNumPoly BigNumPoly::operator/(const BigNumPoly &p) const { return divmod(p).first; }
+BigNumPoly BigNumPoly::operator%(const BigNumPoly &p) const { return divmod(p).second; }
+
+////////// Comparison operators //////////
+
+bool BigNumPoly::operator==(const BigNumPoly &p) const {
+  if (coef.size() != p.coef.size()) return false;
+  for (size_t i = 0; i < coef.size(); ++i) {
+    if (coef[i] != p.coef[i]) return false;
+  }
+  return true;
+}
+
+bool BigNumPoly::operator!=(const BigNumPoly &p) const { return !(*this == p); }
+
+////////// Basic operations //////////
+
+/**
+ * @brief Quotient and remainder of polynomial division
+ * @details The reversed quotient is the reversed dividend times the inverse
+ *          of the reversed divisor as a power series, which takes a constant
+ *          number of multiplications instead of one step per quotient term
+ * @param p Divisor, with leading coefficient 1 or -1
+ * @return (q, r) with this = p * q + r and deg r < deg p
+ * @throws Division by zero, Non-monic divisor
+ * @see https://en.wikipedia.org/wiki/Polynomial_long_division#Fast_division
+*/
+std::pair<BigNumPoly, BigNumPoly> BigNumPoly::divmod(const BigNumPoly &p) const {
+  if (p.coef.empty()) throw "Division by zero";
+  if (p.coef.back() != 1LL && p.coef.back() != -1LL) throw "Non-monic divisor";
+  if (degree() < p.degree()) return std::make_pair(BigNumPoly(), *this);
+
+  size_t n = coef.size(), m = p.coef.size(), k = n - m + 1;
+  BigNumPoly q = (reverse(n).truncate(k) * p.reverse(m).inverse(k)).truncate(k).reverse(k);
+  return std::make_pair(q, *this - p * q);
+}
+
+/**
+ * @brief Evaluate at a point with Horner's rule
+ * @details Each step res * x + c runs in an accumulator
+ * @param x Point
+ * @return Value of the polynomial at x
+*/
+BigNum BigNumPoly::eval(const BigNum &x) const {
+  BigNum res;
+  BigNumAccumulator acc;
+  for (size_t i = coef.size(); i-- > 0;) {
+    acc.clear();
+    acc.add_product(res, x);
+    acc.add(coef[i]);
+    res = acc.value();
+  }
+  return res;
+}
+
+/**
+ * @brief Evaluate at many points
+ * @param points Points
+ * @return Values of the polynomial at every point
+*/
+std::vector<BigNum> BigNumPoly::eval(const std::vector<BigNum> &points) const {
+  if (points.size() > EVAL_THRESHOLD && coef.size() > 1) return eval_tree(points);
+  std::vector<BigNum> res(points.size());
+  for (size_t i = 0; i < points.size(); ++i) res[i] = eval(points[i]);
+  return res;
+}
+
+////////// Helper functions //////////
+
+/**
+ * @brief Evaluate at many points with a subproduct tree
+ * @details Builds the products of (x - points[i]) pairwise up to the root,
+ *          then reduces the polynomial down the tree so that each leaf holds
+ *          its remainder mod (x - points[i]), which is the value at that point
+ * @param points Points
+ * @return Values of the polynomial at every point
+ * @see https://en.wikipedia.org/wiki/Polynomial_evaluation#Multipoint_evaluation
+*/
+std::vector<BigNum> BigNumPoly::eval_tree(const std::vector<BigNum> &points) const {
+  std::vector<BigNum> res(points.size());
+  if (points.empty()) return res;
+
+  // Subproduct tree, leaves first
+  std::vector<std::vector<BigNumPoly>> tree(1);
+  for (const BigNum &x : points) tree[0].push_back(BigNumPoly({neg(x), BigNum(1LL)}));
+  while (tree.back().size() > 1) {
+    const std::vector<BigNumPoly> &below = tree.back();
+    std::vector<BigNumPoly> level;
+    for (size_t i = 0; i < below.size(); i += 2) {
+      level.push_back(i + 1 < below.size() ? below[i] * below[i + 1] : below[i]);
+    }
+    tree.push_back(level);
+  }
+
+  // Remainder tree, root first
+  std::vector<BigNumPoly> rem(1, *this % tree.back()[0]);
+  for (size_t d = tree.size() - 1; d-- > 0;) {
+    std::vector<BigNumPoly> next(tree[d].size());
+    for (size_t i = 0; i < next.size(); ++i) next[i] = rem[i / 2] % tree[d][i];
+    rem.swap(next);
+  }
+
+  for (size_t i = 0; i < points.size(); ++i) res[i] = rem[i][0];
+  return res;
+}
+
+/**
+ * @brief Remove leading zero coefficients
+*/
+void BigNumPoly::trim(void) {
+  while (!coef.empty() && coef.back() == 0LL) coef.pop_back();
+}
+
+/**
+ * @brief Polynomial mod x ^ n
+*/
+BigNumPoly BigNumPoly::truncate(const size_t &n) const {
+  if (coef.size() <= n) return *this;
+  return BigNumPoly(std::vector<BigNum>(coef.begin(), coef.begin() + n));
+}
+
+/**
+ * @brief Reverse the first n coefficients, i.e. x ^ (n - 1) * f(1 / x)
+*/
+BigNumPoly BigNumPoly::reverse(const size_t &n) const {
+  std::vector<BigNum> c(n);
+  for (size_t i = 0; i < n; ++i) c[i] = (*this)[n - 1 - i];
+  return BigNumPoly(c);
+}
+
+/**
+ * @brief Inverse as a power series with Newton's iteration
+ * @details Assume the constant coefficient is 1 or -1
+ *          g = g * (2 - f * g) doubles the number of correct terms
+ * @param n Number of terms
+ * @return g with f * g = 1 mod x ^ n
+*/
+BigNumPoly BigNumPoly::inverse(const size_t &n) const {
+  BigNumPoly g(std::vector<BigNum>(1, coef[0]));
+  for (size_t len = 1; len < n;) {
+    len = len * 2 < n ? len * 2 : n;
+    BigNumPoly e = (truncate(len) * g).truncate(len);
+    g = (g * (BigNumPoly(std::vector<BigNum>(1, BigNum(2LL))) - e)).truncate(len);
+  }
+  return g;
+}
+
+/**
+ * @brief Schoolbook product
+ * @details Each coefficient of the product is a dot product, summed in an
+ *          accumulator without intermediate carries
+ * @param p Polynomial
+ * @return Product of the polynomials
+*/
+BigNumPoly BigNumPoly::mul_naive(const BigNumPoly &p) const {
+  if (coef.empty() || p.coef.empty()) return BigNumPoly();
+  std::vector<BigNumAccumulator> acc(coef.size() + p.coef.size() - 1);
+  for (size_t i = 0; i < coef.size(); ++i) {
+    for (size_t j = 0; j < p.coef.size(); ++j) acc[i + j].add_product(coef[i], p.coef[j]);
+  }
+  std::vector<BigNum> c(acc.size());
+  for (size_t i = 0; i < c.size(); ++i) c[i] = acc[i].value();
+  return BigNumPoly(c);
+}
+
+/**
+ * @brief Product by Kronecker substitution
+ * @details Packs each polynomial into its value at 10 ^ w, where w leaves
+ *          room for the largest possible product coefficient and its sign,
+ *          so one big multiplication yields all coefficients at once.
+ *          Falls back to the schoolbook product for decimal coefficients.
+ * @param p Polynomial
+ * @return Product of the polynomials
+ * @see https://en.wikipedia.org/wiki/Kronecker_substitution
+*/
+BigNumPoly BigNumPoly::mul_kronecker(const BigNumPoly &p) const {
+  if (coef.empty() || p.coef.empty()) return BigNumPoly();
+  size_t da = 0, db = 0;
+  for (const BigNum &x : coef) {
+    if (x.num.find_first_of('.') != std::string::npos) return mul_naive(p);
+    if (x.num.length() > da) da = x.num.length();
+  }
+  for (const BigNum &x : p.coef) {
+    if (x.num.find_first_of('.') != std::string::npos) return mul_naive(p);
+    if (x.num.length() > db) db = x.num.length();
+  }
+
+  // |c[k]| < min(n, m) * 10 ^ (da + db) and one more digit for the sign
+  size_t terms = coef.size() < p.coef.size() ? coef.size() : p.coef.size();
+  int w = da + db + std::to_string(terms).length() + 1;
+
+  bool sa, sb;
+  BigNum a(true, pack(coef, w, sa)), b(true, pack(p.coef, w, sb));
+  BigNum c = a * b;
+  return BigNumPoly(unpack(c.num, sa == sb, w, coef.size() + p.coef.size() - 1));
+}
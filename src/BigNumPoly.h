@@ -0,0 +1,44 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "BigNum.h"
+
+// Polynomial with BigNum coefficients
+class BigNumPoly {
+public:
+  std::vector<BigNum> coef; // coef[i] is the coefficient of x ^ i, no trailing zeros
+
+  // Constructors
+  BigNumPoly(void);
+  BigNumPoly(const std::vector<BigNum> &coef);
+
+  // Properties
+  int degree(void) const;
+  BigNum operator[](const size_t &i) const;
+
+  // Arithmetic operators
+  BigNumPoly operator+(const BigNumPoly &p) const;
+  BigNumPoly operator-(const BigNumPoly &p) const;
+  BigNumPoly operator*(const BigNumPoly &p) const;
+  BigNumPoly operator/(const BigNumPoly &p) const;
+  BigNumPoly operator%(const BigNumPoly &p) const;
+
+  // Comparison operators
+  bool operator==(const BigNumPoly &p) const;
+  bool operator!=(const BigNumPoly &p) const;
+
+  // Basic operations
+  std::pair<BigNumPoly, BigNumPoly> divmod(const BigNumPoly &p) const;
+  BigNum eval(const BigNum &x) const;
+  std::vector<BigNum> eval(const std::vector<BigNum> &points) const;
+
+  // Helper functions
+  std::vector<BigNum> eval_tree(const std::vector<BigNum> &points) const;
+  void trim(void);
+  BigNumPoly truncate(const size_t &n) const;
+  BigNumPoly reverse(const size_t &n) const;
+  BigNumPoly inverse(const size_t &n) const;
+  BigNumPoly mul_naive(const BigNumPoly &p) const;
+  BigNumPoly mul_kronecker(const BigNumPoly &p) const;
+};
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include "BigNum.h"
 #include "BigNumUtils.h"
 
@@ -28,8 +30,8 @@ BigNum gcd(BigNum a, BigNum b) {
  * @see https://en.wikipedia.org/wiki/Least_common_multiple
  * @todo Support decimal numbers
 */
-BigNum lcm(BigNum &a, BigNum &b) {
-  return a / gcd(a, b) * b;
+BigNum lcm(const BigNum &a, const BigNum &b) {
+  return divexact(a, gcd(a, b)) * b;
 }
 
 /**
@@ -56,9 +58,819 @@ BigNum abs(const BigNum &bn) {
 BigNum pow(BigNum base, BigNum exp) {
   BigNum res(1LL);
   while (exp > 0) {
-    if (exp % 2 == 1) res *= base;
+    if (exp.test_bit(0)) res *= base;
     base *= base;
-    exp /= 2;
+    exp >>= 1;
   }
   return res;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Reduce a number into [0, m)
+ * @details Assume m is positive
+ *          Helper function for the modular functions
+ * @param x Number to be reduced
+ * @param m Modulus
+ * @return x mod m
+*/
+static BigNum reduce(BigNum x, BigNum m) {
+  if (x >= 0 && x < m) return x;
+  BigNum r = x % m;
+  if (r < 0) r += m;
+  return r;
+}
+
+/**
+ * @brief Absolute value of an index
+ * @details Negates in unsigned arithmetic so LLONG_MIN is well defined
+ * @param n Index
+ * @return |n|
+*/
+static unsigned long long magnitude(long long n) {
+  return n < 0 ? 0ULL - (unsigned long long)n : (unsigned long long)n;
+}
+
+/**
+ * @brief Fibonacci pair by fast doubling
+ * @details Helper function for fibonacci and lucas
+ *          Uses F(2k) = F(k) * (2F(k+1) - F(k)) and F(2k+1) = F(k)^2 + F(k+1)^2,
+ *          so only O(log n) multiplications are needed
+ * @param n Index
+ * @param m Modulus, or nullptr to compute exactly
+ * @param a Output F(n)
+ * @param b Output F(n+1)
+ * @see https://www.nayuki.io/page/fast-fibonacci-algorithms
+*/
+static void fibonacci_pair(unsigned long long n, const BigNum *m, BigNum &a, BigNum &b) {
+  a = 0LL;
+  b = 1LL;
+  if (m) b = reduce(b, *m);
+
+  int top = 0;
+  while (top < 63 && (n >> (top + 1))) ++top;
+  for (int i = n ? top : -1; i >= 0; --i) {
+    BigNum c = a * (b + b - a);
+    BigNum d = a * a + b * b;
+    if (m) {
+      c = reduce(c, *m);
+      d = reduce(d, *m);
+    }
+    if ((n >> i) & 1) {
+      a = d;
+      b = c + d;
+      if (m) b = reduce(b, *m);
+    } else {
+      a = c;
+      b = d;
+    }
+  }
+}
+
+/**
+ * @brief Fibonacci number
+ * @details Negative indices follow F(-n) = (-1)^(n+1) * F(n)
+ * @param n Index
+ * @return F(n)
+ * @see https://en.wikipedia.org/wiki/Fibonacci_sequence
+*/
+BigNum fibonacci(long long n) {
+  BigNum a, b;
+  fibonacci_pair(magnitude(n), nullptr, a, b);
+  if (n < 0 && !(n & 1)) a = BigNum(0LL) - a;
+  return a;
+}
+
+/**
+ * @brief Fibonacci number modulo m
+ * @details Assume m is positive
+ *          Every intermediate value stays below m ^ 2
+ * @param n Index
+ * @param m Modulus
+ * @return F(n) mod m
+ * @see https://en.wikipedia.org/wiki/Fibonacci_sequence
+*/
+BigNum fibonacci(long long n, const BigNum &m) {
+  BigNum a, b;
+  fibonacci_pair(magnitude(n), &m, a, b);
+  if (n < 0 && !(n & 1)) a = reduce(BigNum(0LL) - a, m);
+  return a;
+}
+
+/**
+ * @brief Lucas number
+ * @details Negative indices follow L(-n) = (-1)^n * L(n)
+ * @param n Index
+ * @return L(n) = 2F(n+1) - F(n)
+ * @see https://en.wikipedia.org/wiki/Lucas_number
+*/
+BigNum lucas(long long n) {
+  BigNum a, b;
+  fibonacci_pair(magnitude(n), nullptr, a, b);
+  BigNum l = b + b - a;
+  if (n < 0 && (n & 1)) l = BigNum(0LL) - l;
+  return l;
+}
+
+/**
+ * @brief Lucas number modulo m
+ * @details Assume m is positive
+ * @param n Index
+ * @param m Modulus
+ * @return L(n) mod m
+ * @see https://en.wikipedia.org/wiki/Lucas_number
+*/
+BigNum lucas(long long n, const BigNum &m) {
+  BigNum a, b;
+  fibonacci_pair(magnitude(n), &m, a, b);
+  BigNum l = reduce(b + b - a, m);
+  if (n < 0 && (n & 1)) l = reduce(BigNum(0LL) - l, m);
+  return l;
+}
+
+/**
+ * @brief Multiply two polynomials modulo the characteristic polynomial
+ * @details Helper function for linear_recurrence
+ *          Reduces with x^k = coef[0] x^(k-1) + ... + coef[k-1]
+ * @param p First polynomial of degree < k
+ * @param q Second polynomial of degree < k
+ * @param coef Recurrence coefficients
+ * @param m Modulus, or nullptr to compute exactly
+ * @return p * q mod the characteristic polynomial
+*/
+static std::vector<BigNum> mul_mod_charpoly(const std::vector<BigNum> &p, const std::vector<BigNum> &q, const std::vector<BigNum> &coef, const BigNum *m) {
+  int k = coef.size();
+  std::vector<BigNum> prod(2 * k - 1);
+  for (int i = 0; i < k; ++i) {
+    if (p[i] == 0) continue;
+    for (int j = 0; j < k; ++j) {
+      if (q[j] != 0) prod[i + j] += p[i] * q[j];
+    }
+  }
+  if (m) {
+    for (int i = k; i < 2 * k - 1; ++i) prod[i] = reduce(prod[i], *m);
+  }
+
+  // Fold the high terms back down, from the top
+  for (int i = 2 * k - 2; i >= k; --i) {
+    if (prod[i] == 0) continue;
+    for (int j = 0; j < k; ++j) {
+      prod[i - 1 - j] += prod[i] * coef[j];
+    }
+    if (m) prod[i - 1] = reduce(prod[i - 1], *m);
+  }
+
+  prod.resize(k);
+  if (m) {
+    for (int i = 0; i < k; ++i) prod[i] = reduce(prod[i], *m);
+  }
+  return prod;
+}
+
+/**
+ * @brief Evaluate a k-term linear recurrence
+ * @details Helper function for linear_recurrence
+ *          Computes x^n modulo the characteristic polynomial by squaring, which
+ *          is the polynomial form of raising the companion matrix to the n-th
+ *          power: O(k^2 log n) multiplications instead of O(k^3 log n)
+ * @param coef Recurrence coefficients
+ * @param init Initial terms
+ * @param n Index
+ * @param m Modulus, or nullptr to compute exactly
+ * @return n-th term of the recurrence
+ * @throws Invalid recurrence
+ * @see https://en.wikipedia.org/wiki/Linear_recurrence_with_constant_coefficients
+*/
+static BigNum linear_recurrence(const std::vector<BigNum> &coef, const std::vector<BigNum> &init, long long n, const BigNum *m) {
+  int k = coef.size();
+  if (k == 0 || init.size() != coef.size() || n < 0) throw "Invalid recurrence";
+  if (n < k) return m ? reduce(init[n], *m) : init[n];
+
+  std::vector<BigNum> c = coef;
+  if (m) {
+    for (int i = 0; i < k; ++i) c[i] = reduce(c[i], *m);
+  }
+
+  // res = x^n, base = x, both modulo the characteristic polynomial
+  std::vector<BigNum> res(k), base(k);
+  res[0] = 1LL;
+  if (k == 1) base[0] = c[0];
+  else base[1] = 1LL;
+  while (n > 0) {
+    if (n & 1) res = mul_mod_charpoly(res, base, c, m);
+    n >>= 1;
+    if (n > 0) base = mul_mod_charpoly(base, base, c, m);
+  }
+
+  BigNum sum;
+  for (int i = 0; i < k; ++i) {
+    if (res[i] != 0) sum += res[i] * init[i];
+  }
+  return m ? reduce(sum, *m) : sum;
+}
+
+/**
+ * @brief Term of a k-term linear recurrence
+ * @details a(i) = coef[0] a(i-1) + coef[1] a(i-2) + ... + coef[k-1] a(i-k)
+ * @param coef Recurrence coefficients
+ * @param init Initial terms a(0), ..., a(k-1)
+ * @param n Index
+ * @return a(n)
+ * @throws Invalid recurrence
+*/
+BigNum linear_recurrence(const std::vector<BigNum> &coef, const std::vector<BigNum> &init, long long n) {
+  return linear_recurrence(coef, init, n, nullptr);
+}
+
+/**
+ * @brief Term of a k-term linear recurrence modulo m
+ * @details Assume m is positive
+ * @param coef Recurrence coefficients
+ * @param init Initial terms a(0), ..., a(k-1)
+ * @param n Index
+ * @param m Modulus
+ * @return a(n) mod m
+ * @throws Invalid recurrence
+*/
+BigNum linear_recurrence(const std::vector<BigNum> &coef, const std::vector<BigNum> &init, long long n, const BigNum &m) {
+  return linear_recurrence(coef, init, n, &m);
+}
+
+
+/**
+ * @brief Power of ten
+ * @param k Exponent
+ * @return 10 ^ k
+*/
+static BigNum pow10(int k) {
+  return BigNum(true, "1" + std::string(k, '0'));
+}
+
+/**
+ * @brief Lowest k decimal digits
+ * @details Assume x is a non-negative integer
+ * @param x Number
+ * @param k Number of digits
+ * @return x mod 10 ^ k
+*/
+static BigNum low_digits(const BigNum &x, int k) {
+  if ((int)x.num.length() <= k) return x;
+  return BigNum(true, x.num.substr(x.num.length() - k));
+}
+
+/**
+ * @brief Drop the lowest k decimal digits
+ * @details Assume x is a non-negative integer
+ * @param x Number
+ * @param k Number of digits
+ * @return x / 10 ^ k
+*/
+static BigNum drop_digits(const BigNum &x, int k) {
+  if ((int)x.num.length() <= k) return BigNum();
+  return BigNum(true, x.num.substr(0, x.num.length() - k));
+}
+
+/**
+ * @brief Whether a number is odd
+ * @details Assume x is an integer
+*/
+static bool is_odd(const BigNum &x) {
+  return (x.num.back() - '0') & 1;
+}
+
+/**
+ * @brief Remainder of the magnitude by a machine-sized divisor
+ * @details Assume x is an integer and 0 < d < 10 ^ 17
+ * @param x Number
+ * @param d Divisor
+ * @return |x| mod d
+*/
+static unsigned long long mod_small(const BigNum &x, unsigned long long d) {
+  unsigned long long r = 0;
+  for (char ch : x.num) r = (r * 10 + (ch - '0')) % d;
+  return r;
+}
+
+/**
+ * @brief Convert a number of at most 18 digits to a long long
+ * @throws Overflow
+*/
+static long long to_ll(const BigNum &x) {
+  if (x.num.length() > 18) throw "Overflow";
+  long long r = std::stoll(x.num);
+  return x.sign ? r : -r;
+}
+
+/**
+ * @brief Table of the primes below 2000
+ * @details Built once with the sieve of Eratosthenes
+ * @see https://en.wikipedia.org/wiki/Sieve_of_Eratosthenes
+*/
+static const std::vector<int> &small_primes(void) {
+  static const std::vector<int> primes = [] {
+    std::vector<int> res;
+    std::vector<bool> composite(2000, false);
+    for (int i = 2; i < 2000; ++i) {
+      if (composite[i]) continue;
+      res.push_back(i);
+      for (int j = i * i; j < 2000; j += i) composite[j] = true;
+    }
+    return res;
+  }();
+  return primes;
+}
+
+/**
+ * @brief Residues of a number modulo every small prime
+ * @details Primes are grouped into products below 10 ^ 17 so that one pass
+ *          over the digits serves several primes
+ * @param x Number
+ * @return x mod p for every p in small_primes()
+*/
+static std::vector<unsigned> small_prime_residues(const BigNum &x) {
+  const std::vector<int> &primes = small_primes();
+  std::vector<unsigned> res(primes.size());
+  for (int i = 0; i < (int)primes.size();) {
+    int j = i;
+    unsigned long long prod = 1;
+    while (j < (int)primes.size() && prod <= 100000000000000000ULL / primes[j]) prod *= primes[j++];
+    unsigned long long r = mod_small(x, prod);
+    for (; i < j; ++i) res[i] = r % primes[i];
+  }
+  return res;
+}
+
+/**
+ * @brief Inverse modulo a power of ten
+ * @details Assume m is a positive integer coprime to 10
+ *          Hensel lifting by Newton's iteration x = x * (2 - m * x), which
+ *          doubles the number of correct digits each step
+ * @param m Number
+ * @param k Number of digits
+ * @return m ^ -1 mod 10 ^ k
+ * @see https://en.wikipedia.org/wiki/Hensel%27s_lemma
+*/
+static BigNum inverse_pow10(const BigNum &m, int k) {
+  static const int digitInv[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+  BigNum x((long long)digitInv[m.num.back() - '0']);
+  for (int p = 1; p < k;) {
+    p = std::min(2 * p, k);
+    BigNum e = BigNum(2LL) - low_digits(low_digits(m, p) * x, p);
+    if (e < 0) e += pow10(p);
+    x = low_digits(x * e, p);
+  }
+  return x;
+}
+
+/**
+ * @brief Exact division
+ * @details Assume a, b are integers and b divides a
+ *          Jebelean's algorithm: factors of 2 and 5 are removed from b with
+ *          shifts and digit cuts, and the quotient by the remaining divisor
+ *          b', coprime to 10, is a * b' ^ -1 mod 10 ^ k where k bounds the
+ *          quotient length. Only multiplications, no trial quotients.
+ * @param a Dividend
+ * @param b Divisor
+ * @return a / b
+ * @throws Division by zero
+ * @see https://doi.org/10.1006/jsco.1993.1042
+*/
+BigNum divexact(const BigNum &a, const BigNum &b) {
+  if (b == 0) throw "Division by zero";
+  if (a == 0) return BigNum();
+  bool sign = a.sign == b.sign;
+  BigNum x(true, a.num), y(true, b.num);
+
+  // Remove common factors of 10, then of 2 and 5
+  size_t tens = y.num.length() - 1 - y.num.find_last_not_of('0');
+  x = drop_digits(x, tens);
+  y = drop_digits(y, tens);
+  long long twos = y.trailing_zeros();
+  x >>= twos;
+  y >>= twos;
+  while (y.num.back() == '5') {
+    x = drop_digits(x << 1, 1);
+    y = drop_digits(y << 1, 1);
+  }
+
+  int k = x.num.length() - y.num.length() + 1;
+  BigNum q = y == 1 ? x : low_digits(low_digits(x, k) * inverse_pow10(y, k), k);
+  return BigNum(sign, q.num);
+}
+
+/**
+ * @brief Create a Montgomery context
+ * @details Uses R = 10 ^ k where k is the number of digits of m, so that
+ *          reducing and dividing by R only cut off decimal digits
+ * @param m Modulus, a positive integer coprime to 10
+ * @throws Invalid modulus
+ * @see https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+*/
+Montgomery::Montgomery(const BigNum &m) : mod(m), digits(m.num.length()) {
+  if (!m.sign || m <= 1 || m.num.find_first_of('.') != std::string::npos) throw "Invalid modulus";
+  int last = m.num.back() - '0';
+  if (last % 2 == 0 || last == 5) throw "Invalid modulus";
+
+  inv = pow10(digits) - inverse_pow10(mod, digits);
+
+  r2 = pow10(2 * digits) % mod;
+  one = redc(r2);
+}
+
+/**
+ * @brief Convert into Montgomery form
+ * @param x Number
+ * @return x * R mod mod
+*/
+BigNum Montgomery::to_mont(const BigNum &x) const {
+  return redc(reduce(x, mod) * r2);
+}
+
+/**
+ * @brief Convert out of Montgomery form
+ * @param x Number in Montgomery form
+ * @return x * R ^ -1 mod mod
+*/
+BigNum Montgomery::from_mont(const BigNum &x) const {
+  return redc(x);
+}
+
+/**
+ * @brief Montgomery reduction
+ * @details Assume 0 <= t < mod * R
+ * @param t Number
+ * @return t * R ^ -1 mod mod
+*/
+BigNum Montgomery::redc(BigNum t) const {
+  BigNum u = low_digits(low_digits(t, digits) * inv, digits);
+  t = drop_digits(t + u * mod, digits);
+  if (t >= mod) t -= mod;
+  return t;
+}
+
+/**
+ * @brief Modular addition
+ * @details Assume a, b are in [0, mod)
+*/
+BigNum Montgomery::add(BigNum a, const BigNum &b) const {
+  a += b;
+  if (a >= mod) a -= mod;
+  return a;
+}
+
+/**
+ * @brief Modular subtraction
+ * @details Assume a, b are in [0, mod)
+*/
+BigNum Montgomery::sub(BigNum a, const BigNum &b) const {
+  a -= b;
+  if (a < 0) a += mod;
+  return a;
+}
+
+/**
+ * @brief Montgomery multiplication
+ * @details Assume a, b are in Montgomery form
+*/
+BigNum Montgomery::mul(BigNum a, const BigNum &b) const {
+  return redc(a * b);
+}
+
+/**
+ * @brief Modular halving
+ * @details Assume a is in [0, mod); works in either form
+*/
+BigNum Montgomery::half(const BigNum &a) const {
+  return is_odd(a) ? (a + mod) >> 1 : a >> 1;
+}
+
+/**
+ * @brief Power in Montgomery form
+ * @details Assume exp is a non-negative integer
+ *          Scans exp one decimal digit at a time, raising to the 10th power
+ *          with four multiplications and then multiplying by a table entry
+ * @param base Base in Montgomery form
+ * @param exp Exponent
+ * @return base ^ exp in Montgomery form
+*/
+BigNum Montgomery::pow_mont(const BigNum &base, const BigNum &exp) const {
+  BigNum table[10];
+  table[0] = one;
+  for (int i = 1; i < 10; ++i) table[i] = mul(table[i - 1], base);
+
+  BigNum res = table[exp.num[0] - '0'];
+  for (int i = 1; i < (int)exp.num.length(); ++i) {
+    BigNum sq = mul(res, res);
+    BigNum p5 = mul(mul(sq, sq), res);
+    res = mul(p5, p5);
+    if (exp.num[i] != '0') res = mul(res, table[exp.num[i] - '0']);
+  }
+  return res;
+}
+
+/**
+ * @brief Power modulo mod
+ * @details Assume exp is a non-negative integer
+ * @param base Base
+ * @param exp Exponent
+ * @return base ^ exp mod mod
+*/
+BigNum Montgomery::pow(const BigNum &base, const BigNum &exp) const {
+  return from_mont(pow_mont(to_mont(base), exp));
+}
+
+/**
+ * @brief Modular power
+ * @details Assume exp is a non-negative integer and m is positive
+ *          Uses a Montgomery context when m is coprime to 10
+ * @param base Base
+ * @param exp Exponent
+ * @param m Modulus
+ * @return base ^ exp mod m
+ * @throws Negative exponent
+ * @see https://en.wikipedia.org/wiki/Modular_exponentiation
+*/
+BigNum powmod(BigNum base, const BigNum &exp, const BigNum &m) {
+  if (!exp.sign && exp != 0) throw "Negative exponent";
+  if (m == 1) return BigNum();
+  int last = m.num.back() - '0';
+  if (last % 2 == 1 && last != 5) return Montgomery(m).pow(base, exp);
+
+  BigNum res(1LL), e = exp;
+  base = reduce(base, m);
+  while (e > 0) {
+    if (is_odd(e)) res = reduce(res * base, m);
+    base = reduce(base * base, m);
+    e >>= 1;
+  }
+  return res;
+}
+
+/**
+ * @brief Jacobi symbol of two machine-sized numbers
+ * @details Assume a is non-negative and n is odd and positive
+ * @see https://en.wikipedia.org/wiki/Jacobi_symbol#Calculating_the_Jacobi_symbol
+*/
+static int jacobi(long long a, long long n) {
+  int res = 1;
+  a %= n;
+  while (a) {
+    while (a % 2 == 0) {
+      a /= 2;
+      if (n % 8 == 3 || n % 8 == 5) res = -res;
+    }
+    std::swap(a, n);
+    if (a % 4 == 3 && n % 4 == 3) res = -res;
+    a %= n;
+  }
+  return n == 1 ? res : 0;
+}
+
+/**
+ * @brief Jacobi symbol (d / n) for small d
+ * @details Assume n is odd and positive
+ *          Reduces to machine-sized numbers by quadratic reciprocity
+*/
+static int jacobi(long long d, const BigNum &n) {
+  int res = 1;
+  unsigned long long n8 = mod_small(n, 8);
+  if (d < 0) {
+    d = -d;
+    if (n8 % 4 == 3) res = -res;
+  }
+  while (d && d % 2 == 0) {
+    d /= 2;
+    if (n8 == 3 || n8 == 5) res = -res;
+  }
+  if (d == 0) return 0;
+  if (d % 4 == 3 && n8 % 4 == 3) res = -res;
+  return res * jacobi((long long)mod_small(n, d), d);
+}
+
+/**
+ * @brief Whether a number is a perfect square
+ * @details Assume n is a positive integer
+ *          Integer square root by Newton's method
+*/
+static bool is_square(const BigNum &n) {
+  BigNum x = pow10((n.num.length() + 1) / 2);
+  while (true) {
+    BigNum y = (x + n / x) >> 1;
+    if (y >= x) break;
+    x = y;
+  }
+  return x * x == n;
+}
+
+/**
+ * @brief Miller-Rabin test to a single base
+ * @details Assume mod - 1 = d * 2 ^ s with d odd
+ * @see https://en.wikipedia.org/wiki/Miller%E2%80%93Rabin_primality_test
+*/
+static bool miller_rabin(const Montgomery &ctx, const BigNum &d, int s, long long a) {
+  BigNum minusOne = ctx.sub(BigNum(), ctx.one);
+  BigNum x = ctx.pow_mont(ctx.to_mont(BigNum(a)), d);
+  if (x == ctx.one || x == minusOne) return true;
+  for (int r = 1; r < s; ++r) {
+    x = ctx.mul(x, x);
+    if (x == minusOne) return true;
+    if (x == ctx.one) return false;
+  }
+  return false;
+}
+
+/**
+ * @brief Strong Lucas probable prime test
+ * @details Assume n is odd, not a small prime multiple, and above 2000
+ *          Parameters chosen by Selfridge's method A: P = 1, Q = (1 - D) / 4
+ * @see https://en.wikipedia.org/wiki/Lucas_pseudoprime#Strong_Lucas_pseudoprimes
+*/
+static bool strong_lucas(const Montgomery &ctx, const BigNum &n) {
+  // Find D in 5, -7, 9, -11, ... with (D / n) = -1
+  long long d = 5;
+  for (int tries = 1;; ++tries) {
+    int j = jacobi(d, n);
+    if (j == -1) break;
+    if (j == 0) return false;
+    if (tries == 32 && is_square(n)) return false;
+    d = d > 0 ? -(d + 2) : -(d - 2);
+  }
+  BigNum dm = ctx.to_mont(BigNum(d)), qm = ctx.to_mont(BigNum((1 - d) / 4));
+
+  // n + 1 = k * 2 ^ s with k odd
+  BigNum k = n + 1LL;
+  int s = k.trailing_zeros();
+  k >>= s;
+  std::vector<bool> bits;
+  for (uint32_t limb : k.to_limbs(k.num)) {
+    for (int b = 0; b < 32; ++b) bits.push_back((limb >> b) & 1);
+  }
+  while (!bits.back()) bits.pop_back();
+
+  // Binary ladder for U_k, V_k and Q ^ k, all in Montgomery form
+  BigNum u = ctx.one, v = ctx.one, qk = qm;
+  for (int i = (int)bits.size() - 2; i >= 0; --i) {
+    u = ctx.mul(u, v);
+    v = ctx.sub(ctx.mul(v, v), ctx.add(qk, qk));
+    qk = ctx.mul(qk, qk);
+    if (bits[i]) {
+      BigNum nu = ctx.half(ctx.add(u, v));
+      v = ctx.half(ctx.add(ctx.mul(dm, u), v));
+      u = nu;
+      qk = ctx.mul(qk, qm);
+    }
+  }
+
+  if (u == 0 || v == 0) return true;
+  for (int r = 1; r < s; ++r) {
+    v = ctx.sub(ctx.mul(v, v), ctx.add(qk, qk));
+    if (v == 0) return true;
+    qk = ctx.mul(qk, qk);
+  }
+  return false;
+}
+
+/**
+ * @brief Baillie-PSW test on a number with no small prime factor
+ * @details Assume n is above 2000 and has no prime factor below 2000
+ * @param n Number
+ * @param rounds Extra Miller-Rabin rounds to bases 3, 5, 7, ...
+ * @see https://en.wikipedia.org/wiki/Baillie%E2%80%93PSW_primality_test
+*/
+static bool baillie_psw(const BigNum &n, int rounds) {
+  const std::vector<int> &primes = small_primes();
+  if (n < (long long)primes.back() * primes.back()) return true;
+
+  Montgomery ctx(n);
+  BigNum d = n - 1LL;
+  int s = d.trailing_zeros();
+  d >>= s;
+  if (!miller_rabin(ctx, d, s, 2)) return false;
+  for (int i = 1; i <= rounds && i < (int)primes.size(); ++i) {
+    if (!miller_rabin(ctx, d, s, primes[i])) return false;
+  }
+  return strong_lucas(ctx, n);
+}
+
+/**
+ * @brief Probabilistic primality test
+ * @details Trial division by the primes below 2000, then Baillie-PSW, which
+ *          has no known counterexample
+ * @param n Number
+ * @param rounds Extra Miller-Rabin rounds to bases 3, 5, 7, ...
+ * @return Whether n is a probable prime
+*/
+bool is_probable_prime(const BigNum &n, int rounds) {
+  if (!n.sign || n < 2 || n.num.find_first_of('.') != std::string::npos) return false;
+
+  const std::vector<int> &primes = small_primes();
+  if (n <= primes.back()) return std::binary_search(primes.begin(), primes.end(), (int)to_ll(n));
+  std::vector<unsigned> residues = small_prime_residues(n);
+  for (unsigned r : residues) {
+    if (r == 0) return false;
+  }
+
+  return baillie_psw(n, rounds);
+}
+
+/**
+ * @brief Sieve a window of consecutive numbers by the small primes
+ * @details Assume start >= 2
+ * @param start First number of the window
+ * @param count Size of the window
+ * @return Numbers in the window without a small prime factor, ascending
+*/
+static std::vector<BigNum> sieve_window(const BigNum &start, long long count) {
+  const std::vector<int> &primes = small_primes();
+  std::vector<unsigned> residues = small_prime_residues(start);
+  // A small prime inside the window is prime itself; larger starts are past every small prime
+  long long small = start.num.length() <= 4 ? to_ll(start) : -1;
+
+  std::vector<bool> composite(count, false);
+  for (int i = 0; i < (int)primes.size(); ++i) {
+    long long p = primes[i];
+    for (long long j = (p - residues[i]) % p; j < count; j += p) {
+      if (small < 0 || small + j != p) composite[j] = true;
+    }
+  }
+
+  std::vector<BigNum> res;
+  for (long long j = 0; j < count; ++j) {
+    if (!composite[j]) res.push_back(start + j);
+  }
+  return res;
+}
+
+/**
+ * @brief Test sieved candidates in parallel
+ * @details Lower candidates are dealt first, so with firstOnly the pool can
+ *          skip everything above the smallest prime found so far
+ * @param cands Candidates without a small prime factor
+ * @param pool Thread pool
+ * @param firstOnly Stop once the smallest prime among cands is known
+ * @return Whether each candidate is a probable prime
+*/
+static std::vector<char> test_candidates(const std::vector<BigNum> &cands, ThreadPool &pool, bool firstOnly) {
+  std::vector<char> res(cands.size(), 0);
+  std::atomic<size_t> first(cands.size());
+  pool.run(cands.size(),
+           [&](size_t i) { return cands.size() - i; },
+           [&](size_t i) {
+             if (firstOnly && i > first) return;
+             if (!baillie_psw(cands[i], 0)) return;
+             res[i] = 1;
+             size_t cur = first;
+             while (i < cur && !first.compare_exchange_weak(cur, i));
+           });
+  return res;
+}
+
+/**
+ * @brief Smallest probable prime greater than n
+ * @details Sieves windows past n and tests the survivors in parallel
+ * @param n Number
+ * @param pool Thread pool
+ * @return Next probable prime
+*/
+BigNum next_prime(const BigNum &n, ThreadPool &pool) {
+  if (n < 2) return BigNum(2LL);
+  BigNum start = BigNum(true, n.num.substr(0, n.num.find_first_of('.'))) + 1LL;
+  long long window = std::max<long long>(256, 64 * (long long)n.num.length());
+
+  while (true) {
+    std::vector<BigNum> cands = sieve_window(start, window);
+    std::vector<char> prime = test_candidates(cands, pool, true);
+    for (size_t i = 0; i < cands.size(); ++i) {
+      if (prime[i]) return cands[i];
+    }
+    start += window;
+  }
+}
+
+/**
+ * @brief All probable primes in a range
+ * @details Sieves the range in windows and tests the survivors in parallel
+ * @param lo Lower bound, inclusive
+ * @param hi Upper bound, inclusive
+ * @param pool Thread pool
+ * @return Probable primes in [lo, hi], ascending
+ * @throws Overflow if the range has more than 10 ^ 18 numbers
+*/
+std::vector<BigNum> find_primes(const BigNum &lo, const BigNum &hi, ThreadPool &pool) {
+  std::vector<BigNum> res;
+  BigNum start = lo < 2 ? BigNum(2LL) : lo;
+  if (hi < start) return res;
+  long long remain = to_ll(hi - start) + 1;
+
+  const long long window = 1 << 16;
+  while (remain > 0) {
+    long long count = std::min(remain, window);
+    std::vector<BigNum> cands = sieve_window(start, count);
+    std::vector<char> prime = test_candidates(cands, pool, false);
+    for (size_t i = 0; i < cands.size(); ++i) {
+      if (prime[i]) res.push_back(cands[i]);
+    }
+    start += count;
+    remain -= count;
+  }
+  return res;
+}
@@ -1,9 +1,54 @@
 #pragma once
 
+#include <vector>
 #include "BigNum.h"
+#include "BigNumBatch.h"
 
 // Utility functions for BigNums
 BigNum gcd(BigNum a, BigNum b);
-BigNum lcm(BigNum &a, BigNum &b);
+BigNum lcm(const BigNum &a, const BigNum &b);
+BigNum divexact(const BigNum &a, const BigNum &b);
 BigNum abs(const BigNum &bn);
-BigNum pow(BigNum base, BigNum exp);
\ No newline at end of file
+BigNum pow(BigNum base, BigNum exp);
+
+// Sequences
+BigNum fibonacci(long long n);
+BigNum fibonacci(long long n, const BigNum &m);
+BigNum lucas(long long n);
+BigNum lucas(long long n, const BigNum &m);
+BigNum linear_recurrence(const std::vector<BigNum> &coef, const std::vector<BigNum> &init, long long n);
+BigNum linear_recurrence(const std::vector<BigNum> &coef, const std::vector<BigNum> &init, long long n, const BigNum &m);
+
+// Montgomery context for repeated arithmetic modulo a fixed odd modulus
+class Montgomery {
+public:
+  BigNum mod;
+  int digits; // R = 10 ^ digits > mod
+  BigNum inv; // -mod ^ -1 mod R
+  BigNum r2;  // R ^ 2 mod mod
+  BigNum one; // R mod mod, i.e. 1 in Montgomery form
+
+  // Constructors
+  Montgomery(const BigNum &m);
+
+  // Conversion
+  BigNum to_mont(const BigNum &x) const;
+  BigNum from_mont(const BigNum &x) const;
+
+  // Basic operations, on numbers in Montgomery form
+  BigNum redc(BigNum t) const;
+  BigNum add(BigNum a, const BigNum &b) const;
+  BigNum sub(BigNum a, const BigNum &b) const;
+  BigNum mul(BigNum a, const BigNum &b) const;
+  BigNum half(const BigNum &a) const;
+  BigNum pow_mont(const BigNum &base, const BigNum &exp) const;
+
+  // Power modulo mod, on ordinary numbers
+  BigNum pow(const BigNum &base, const BigNum &exp) const;
+};
+
+// Primes
+BigNum powmod(BigNum base, const BigNum &exp, const BigNum &m);
+bool is_probable_prime(const BigNum &n, int rounds = 0);
+BigNum next_prime(const BigNum &n, ThreadPool &pool = ThreadPool::shared());
+std::vector<BigNum> find_primes(const BigNum &lo, const BigNum &hi, ThreadPool &pool = ThreadPool::shared());
\ No newline at end of file
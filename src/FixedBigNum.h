@@ -0,0 +1,413 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include "BigNum.h"
+
+/**
+ * @brief Fixed-width unsigned integer of Bits bits
+ * @details Stored as Bits / 32 little-endian 32-bit limbs on the stack,
+ *          so no operation allocates. All arithmetic wraps modulo 2 ^ Bits
+ *          like the built-in unsigned types, and every loop runs over a
+ *          compile-time limb count so the compiler can fully unroll it.
+ *          Everything except the BigNum conversions is constexpr.
+ * @tparam Bits Width in bits, a positive multiple of 32
+*/
+template <std::size_t Bits>
+class FixedBigNum {
+  static_assert(Bits > 0 && Bits % 32 == 0, "FixedBigNum width must be a positive multiple of 32");
+
+public:
+  static constexpr std::size_t bits = Bits;
+  static constexpr std::size_t limbs = Bits / 32;
+
+  std::uint32_t limb[limbs]; // limb[0] is the least significant
+
+  // Constructors
+  constexpr FixedBigNum(void) : limb{} {}
+  constexpr FixedBigNum(const unsigned long long &n) : limb{} {
+    limb[0] = (std::uint32_t)n;
+    if (limbs > 1) limb[1 % limbs] = (std::uint32_t)(n >> 32);
+  }
+  template <std::size_t B, typename std::enable_if<(B < Bits), int>::type = 0>
+  constexpr FixedBigNum(const FixedBigNum<B> &fb) : limb{} {
+    for (std::size_t i = 0; i < FixedBigNum<B>::limbs; ++i) limb[i] = fb.limb[i];
+  }
+  template <std::size_t B, typename std::enable_if<(B > Bits), int>::type = 0>
+  explicit constexpr FixedBigNum(const FixedBigNum<B> &fb) : limb{} {
+    for (std::size_t i = 0; i < limbs; ++i) limb[i] = fb.limb[i];
+  }
+  explicit FixedBigNum(const BigNum &bn);
+
+  // Conversion
+  BigNum to_bignum(void) const;
+  explicit operator BigNum(void) const { return to_bignum(); }
+  friend std::ostream &operator<<(std::ostream &os, const FixedBigNum &fb) { return os << fb.to_bignum(); }
+
+  // Arithmetic operators
+  constexpr FixedBigNum operator+(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < limbs; ++i) {
+      carry += (std::uint64_t)limb[i] + fb.limb[i];
+      c.limb[i] = (std::uint32_t)carry;
+      carry >>= 32;
+    }
+    return c;
+  }
+  constexpr FixedBigNum operator-(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < limbs; ++i) {
+      std::uint64_t diff = (std::uint64_t)limb[i] - fb.limb[i] - borrow;
+      c.limb[i] = (std::uint32_t)diff;
+      borrow = (diff >> 32) & 1;
+    }
+    return c;
+  }
+  constexpr FixedBigNum operator*(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    for (std::size_t i = 0; i < limbs; ++i) {
+      std::uint64_t carry = 0;
+      for (std::size_t j = 0; i + j < limbs; ++j) {
+        carry += (std::uint64_t)limb[i] * fb.limb[j] + c.limb[i + j];
+        c.limb[i + j] = (std::uint32_t)carry;
+        carry >>= 32;
+      }
+    }
+    return c;
+  }
+  constexpr FixedBigNum operator/(const FixedBigNum &fb) const { return divmod(*this, fb).quot; }
+  constexpr FixedBigNum operator%(const FixedBigNum &fb) const { return divmod(*this, fb).rem; }
+  constexpr FixedBigNum &operator+=(const FixedBigNum &fb) { return *this = *this + fb; }
+  constexpr FixedBigNum &operator-=(const FixedBigNum &fb) { return *this = *this - fb; }
+  constexpr FixedBigNum &operator*=(const FixedBigNum &fb) { return *this = *this * fb; }
+  constexpr FixedBigNum &operator/=(const FixedBigNum &fb) { return *this = *this / fb; }
+  constexpr FixedBigNum &operator%=(const FixedBigNum &fb) { return *this = *this % fb; }
+
+  // Bitwise operators
+  constexpr FixedBigNum operator<<(const std::size_t &k) const {
+    FixedBigNum c;
+    if (k >= Bits) return c;
+    std::size_t q = k / 32, r = k % 32;
+    for (std::size_t i = limbs; i-- > q;) {
+      c.limb[i] = limb[i - q] << r;
+      if (r && i > q) c.limb[i] |= limb[i - q - 1] >> (32 - r);
+    }
+    return c;
+  }
+  constexpr FixedBigNum operator>>(const std::size_t &k) const {
+    FixedBigNum c;
+    if (k >= Bits) return c;
+    std::size_t q = k / 32, r = k % 32;
+    for (std::size_t i = 0; i + q < limbs; ++i) {
+      c.limb[i] = limb[i + q] >> r;
+      if (r && i + q + 1 < limbs) c.limb[i] |= limb[i + q + 1] << (32 - r);
+    }
+    return c;
+  }
+  constexpr FixedBigNum operator&(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    for (std::size_t i = 0; i < limbs; ++i) c.limb[i] = limb[i] & fb.limb[i];
+    return c;
+  }
+  constexpr FixedBigNum operator|(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    for (std::size_t i = 0; i < limbs; ++i) c.limb[i] = limb[i] | fb.limb[i];
+    return c;
+  }
+  constexpr FixedBigNum operator^(const FixedBigNum &fb) const {
+    FixedBigNum c;
+    for (std::size_t i = 0; i < limbs; ++i) c.limb[i] = limb[i] ^ fb.limb[i];
+    return c;
+  }
+  constexpr FixedBigNum operator~(void) const {
+    FixedBigNum c;
+    for (std::size_t i = 0; i < limbs; ++i) c.limb[i] = ~limb[i];
+    return c;
+  }
+  constexpr FixedBigNum &operator<<=(const std::size_t &k) { return *this = *this << k; }
+  constexpr FixedBigNum &operator>>=(const std::size_t &k) { return *this = *this >> k; }
+
+  // Comparison operators
+  constexpr int compare(const FixedBigNum &fb) const {
+    for (std::size_t i = limbs; i-- > 0;) {
+      if (limb[i] != fb.limb[i]) return limb[i] < fb.limb[i] ? -1 : 1;
+    }
+    return 0;
+  }
+  constexpr bool operator==(const FixedBigNum &fb) const { return compare(fb) == 0; }
+  constexpr bool operator!=(const FixedBigNum &fb) const { return compare(fb) != 0; }
+  constexpr bool operator<(const FixedBigNum &fb) const { return compare(fb) < 0; }
+  constexpr bool operator<=(const FixedBigNum &fb) const { return compare(fb) <= 0; }
+  constexpr bool operator>(const FixedBigNum &fb) const { return compare(fb) > 0; }
+  constexpr bool operator>=(const FixedBigNum &fb) const { return compare(fb) >= 0; }
+
+  // Helper functions
+  constexpr bool is_zero(void) const {
+    for (std::size_t i = 0; i < limbs; ++i) if (limb[i]) return false;
+    return true;
+  }
+  constexpr std::size_t bit_length(void) const {
+    for (std::size_t i = limbs; i-- > 0;) {
+      if (limb[i]) return i * 32 + 32 - clz(limb[i]);
+    }
+    return 0;
+  }
+
+  // Basic operations
+  struct DivMod;
+  static constexpr DivMod divmod(const FixedBigNum &a, const FixedBigNum &b);
+  static constexpr std::uint32_t divmod_small(FixedBigNum &a, const std::uint32_t &d);
+  static constexpr bool mul_add_small(FixedBigNum &a, const std::uint32_t &m, const std::uint32_t &c);
+  static constexpr FixedBigNum parse(const char *s, const std::size_t &len);
+
+private:
+  static constexpr std::size_t clz(std::uint32_t x) {
+    std::size_t n = 0;
+    while (!(x & 0x80000000u)) { x <<= 1; ++n; }
+    return n;
+  }
+};
+
+template <std::size_t Bits>
+constexpr std::size_t FixedBigNum<Bits>::bits;
+template <std::size_t Bits>
+constexpr std::size_t FixedBigNum<Bits>::limbs;
+
+template <std::size_t Bits>
+struct FixedBigNum<Bits>::DivMod {
+  FixedBigNum quot;
+  FixedBigNum rem;
+};
+
+/**
+ * @brief Quotient and remainder of two fixed-width numbers
+ * @details Single-limb divisors use short division, everything else uses
+ *          Knuth's Algorithm D on 32-bit limbs
+ * @param a Dividend
+ * @param b Divisor
+ * @return Quotient and remainder of a and b
+ * @throws Division by zero
+ * @see https://en.wikipedia.org/wiki/Division_algorithm#Long_division
+*/
+template <std::size_t Bits>
+constexpr typename FixedBigNum<Bits>::DivMod FixedBigNum<Bits>::divmod(const FixedBigNum &a, const FixedBigNum &b) {
+  DivMod res{FixedBigNum(), FixedBigNum()};
+
+  // Edge cases
+  std::size_t n = limbs;
+  while (n > 0 && !b.limb[n - 1]) --n;
+  if (n == 0) throw "Division by zero";
+  if (a < b) { res.rem = a; return res; }
+
+  // Short division for single-limb divisors
+  if (n == 1) {
+    res.quot = a;
+    res.rem = FixedBigNum(divmod_small(res.quot, b.limb[0]));
+    return res;
+  }
+
+  std::size_t m = limbs;
+  while (!a.limb[m - 1]) --m;
+
+  // Normalize so that the top limb of the divisor has its high bit set
+  std::size_t s = clz(b.limb[n - 1]);
+  std::uint32_t vn[limbs] = {}, un[limbs + 1] = {};
+  for (std::size_t i = n - 1; i > 0; --i) vn[i] = (b.limb[i] << s) | (s ? b.limb[i - 1] >> (32 - s) : 0);
+  vn[0] = b.limb[0] << s;
+  un[m] = s ? a.limb[m - 1] >> (32 - s) : 0;
+  for (std::size_t i = m - 1; i > 0; --i) un[i] = (a.limb[i] << s) | (s ? a.limb[i - 1] >> (32 - s) : 0);
+  un[0] = a.limb[0] << s;
+
+  const std::uint64_t base = 1ULL << 32;
+  for (std::size_t j = m - n + 1; j-- > 0;) {
+    // Estimate the quotient limb from the top two limbs
+    std::uint64_t num = ((std::uint64_t)un[j + n] << 32) | un[j + n - 1];
+    std::uint64_t qhat = num / vn[n - 1], rhat = num % vn[n - 1];
+    while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if (rhat >= base) break;
+    }
+
+    // Multiply and subtract
+    std::int64_t borrow = 0, t = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint64_t p = qhat * vn[i];
+      t = (std::int64_t)un[i + j] - borrow - (std::int64_t)(p & 0xFFFFFFFFu);
+      un[i + j] = (std::uint32_t)t;
+      borrow = (std::int64_t)(p >> 32) - (t >> 32);
+    }
+    t = (std::int64_t)un[j + n] - borrow;
+    un[j + n] = (std::uint32_t)t;
+
+    // Add back if the estimate was one too large
+    if (t < 0) {
+      --qhat;
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        carry += (std::uint64_t)un[i + j] + vn[i];
+        un[i + j] = (std::uint32_t)carry;
+        carry >>= 32;
+      }
+      un[j + n] += (std::uint32_t)carry;
+    }
+    res.quot.limb[j] = (std::uint32_t)qhat;
+  }
+
+  // Unnormalize the remainder
+  for (std::size_t i = 0; i < n; ++i) res.rem.limb[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0);
+
+  return res;
+}
+
+/**
+ * @brief Divide in place by a single limb
+ * @param a Dividend, replaced by the quotient
+ * @param d Divisor
+ * @return Remainder of a and d
+ * @throws Division by zero
+*/
+template <std::size_t Bits>
+constexpr std::uint32_t FixedBigNum<Bits>::divmod_small(FixedBigNum &a, const std::uint32_t &d) {
+  if (d == 0) throw "Division by zero";
+  std::uint64_t rem = 0;
+  for (std::size_t i = limbs; i-- > 0;) {
+    rem = (rem << 32) | a.limb[i];
+    a.limb[i] = (std::uint32_t)(rem / d);
+    rem %= d;
+  }
+  return (std::uint32_t)rem;
+}
+
+/**
+ * @brief Compute a * m + c in place
+ * @param a Number, replaced by the result
+ * @param m Multiplier
+ * @param c Addend
+ * @return Whether the result overflowed Bits bits
+*/
+template <std::size_t Bits>
+constexpr bool FixedBigNum<Bits>::mul_add_small(FixedBigNum &a, const std::uint32_t &m, const std::uint32_t &c) {
+  std::uint64_t carry = c;
+  for (std::size_t i = 0; i < limbs; ++i) {
+    carry += (std::uint64_t)a.limb[i] * m;
+    a.limb[i] = (std::uint32_t)carry;
+    carry >>= 32;
+  }
+  return carry != 0;
+}
+
+/**
+ * @brief Base of an integer literal, from its prefix like built-in literals
+ * @param s Characters of the literal
+ * @param len Number of characters
+ * @param prefix Output number of prefix characters
+ * @return 16 for 0x, 2 for 0b, 8 for a leading 0, otherwise 10
+*/
+constexpr std::uint32_t fixed_bignum_literal_base(const char *s, const std::size_t &len, std::size_t &prefix) {
+  prefix = 0;
+  if (len < 2 || s[0] != '0') return 10;
+  if (s[1] == 'x' || s[1] == 'X') { prefix = 2; return 16; }
+  if (s[1] == 'b' || s[1] == 'B') { prefix = 2; return 2; }
+  prefix = 1;
+  return 8;
+}
+
+/**
+ * @brief Parse an integer literal
+ * @details Accepts decimal, 0x / 0X hexadecimal, 0b / 0B binary and
+ *          0-prefixed octal digits like the built-in integer literals,
+ *          ignoring ' digit separators
+ * @param s Characters of the literal
+ * @param len Number of characters
+ * @return Parsed number
+ * @throws Invalid digit, Overflow
+*/
+template <std::size_t Bits>
+constexpr FixedBigNum<Bits> FixedBigNum<Bits>::parse(const char *s, const std::size_t &len) {
+  FixedBigNum res;
+  std::size_t prefix = 0;
+  std::uint32_t base = fixed_bignum_literal_base(s, len, prefix);
+  for (std::size_t i = prefix; i < len; ++i) {
+    char ch = s[i];
+    if (ch == '\'') continue;
+    std::uint32_t digit = base;
+    if (ch >= '0' && ch <= '9') digit = ch - '0';
+    else if (ch >= 'a' && ch <= 'f') digit = ch - 'a' + 10;
+    else if (ch >= 'A' && ch <= 'F') digit = ch - 'A' + 10;
+    if (digit >= base) throw "Invalid digit";
+    if (mul_add_small(res, base, digit)) throw "Overflow";
+  }
+  return res;
+}
+
+/**
+ * @brief Convert a BigNum to a fixed-width number
+ * @details Lossless: the BigNum must be a non-negative integer below 2 ^ Bits
+ * @param bn Big number
+ * @throws Negative number, Decimal number, Overflow
+*/
+template <std::size_t Bits>
+FixedBigNum<Bits>::FixedBigNum(const BigNum &bn) : limb{} {
+  if (!bn.sign && bn.num != "0") throw "Negative number";
+  if (bn.num.find_first_of('.') != std::string::npos) throw "Decimal number";
+
+  // Consume nine decimal digits at a time
+  const std::string &s = bn.num;
+  std::size_t head = s.length() % 9 ? s.length() % 9 : 9;
+  for (std::size_t i = 0; i < s.length(); i += (i ? 9 : head)) {
+    std::size_t len = i ? 9 : head;
+    std::uint32_t chunk = (std::uint32_t)std::stoul(s.substr(i, len)), scale = 1;
+    for (std::size_t j = 0; j < len; ++j) scale *= 10;
+    if (mul_add_small(*this, scale, chunk)) throw "Overflow";
+  }
+}
+
+/**
+ * @brief Convert a fixed-width number to a BigNum
+ * @return Big number with the same value
+*/
+template <std::size_t Bits>
+BigNum FixedBigNum<Bits>::to_bignum(void) const {
+  // Peel off nine decimal digits at a time
+  FixedBigNum x = *this;
+  std::string s;
+  do {
+    std::string chunk = std::to_string(divmod_small(x, 1000000000u));
+    s.insert(0, chunk);
+    if (!x.is_zero()) s.insert(0, 9 - chunk.length(), '0');
+  } while (!x.is_zero());
+  return BigNum(true, s);
+}
+
+/**
+ * @brief Number of bits needed to hold an integer literal
+ * @details Rounded up to a multiple of 64; decimal digits need at most
+ *          log2(10) < 3.33 bits each, and hexadecimal, octal and binary
+ *          digits exactly 4, 3 and 1
+*/
+template <char... Cs>
+constexpr std::size_t fixed_bignum_literal_bits(void) {
+  const char s[] = {Cs...};
+  std::size_t len = sizeof...(Cs), digits = 0, prefix = 0;
+  std::uint32_t base = fixed_bignum_literal_base(s, len, prefix);
+  for (std::size_t i = prefix; i < len; ++i) if (s[i] != '\'') ++digits;
+  std::size_t bits = base == 16 ? digits * 4 : base == 8 ? digits * 3 : base == 2 ? digits : digits * 333 / 100 + 1;
+  return (bits + 63) / 64 * 64;
+}
+
+/**
+ * @brief Fixed-width integer literal, e.g. 123456789012345678901234567890_bn or 0b1010_bn
+ * @details Parsed at compile time into the narrowest FixedBigNum (a
+ *          multiple of 64 bits) that holds it; it widens implicitly
+*/
+template <char... Cs>
+constexpr FixedBigNum<fixed_bignum_literal_bits<Cs...>()> operator"" _bn(void) {
+  const char s[] = {Cs...};
+  return FixedBigNum<fixed_bignum_literal_bits<Cs...>()>::parse(s, sizeof...(Cs));
+}
@@ -1,4 +1,14 @@
 #include "../src/BigNum.h"
+#include "../src/BigNumUtils.h"
+#include "../src/BigNumBinary.h"
+#include "../src/BigNumBatch.h"
+#include "../src/BigNumDivisor.h"
+#include "../src/BigNumAccumulator.h"
+#include "../src/BigNumPoly.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include "../src/FixedBigNum.h"
 #include <gtest/gtest.h>
 
 TEST(BigNumTest, Trim) {
@@ -32,6 +42,91 @@ TEST(BigNumTest, Padding) {
   EXPECT_EQ(num6.num, "76543.2100");
 }
 
+TEST(BigNumTest, SharedStorage) {
+  BigNum num1("123456789012345678901234567890");
+  BigNum num2 = num1, num3(false, num1.num);
+  EXPECT_EQ(num1.num.c_str(), num2.num.c_str());
+  EXPECT_EQ(num1.num.c_str(), num3.num.c_str());
+  EXPECT_EQ(num1.num.use_count(), 3);
+
+  // Editing unshares the digits first
+  BigNum num4("1.5");
+  num2.padding(num2.num, num4.num);
+  EXPECT_EQ(num1.num, "123456789012345678901234567890");
+  EXPECT_EQ(num2.num, "123456789012345678901234567890.0");
+  EXPECT_EQ(num1.num.use_count(), 2);
+
+  // Moving transfers the digits and the cached decimal point without a copy
+  BigNum num5("-12.75");
+  const char *digits = num5.num.c_str();
+  BigNum num6(std::move(num5));
+  EXPECT_EQ(num6.num.c_str(), digits);
+  EXPECT_EQ(num6.num.use_count(), 1);
+  EXPECT_EQ(num6.num.point(), 2u);
+  num5 = std::move(num6);
+  EXPECT_EQ(num5.num.c_str(), digits);
+  EXPECT_EQ(num5, BigNum("-12.75"));
+
+  // Const numbers can be shared by many threads without copying
+  const BigNum m("1000000000000000000000000000057");
+  std::vector<BigNum> res(64);
+  ThreadPool pool(4);
+  pool.run(res.size(), [](size_t) { return 1; }, [&](size_t i) { res[i] = (m * (long long)i + m) % m; });
+  for (const BigNum &r : res) EXPECT_EQ(r, 0);
+  EXPECT_EQ(m.num.use_count(), 1);
+}
+
+TEST(BigNumTest, LongDouble) {
+  EXPECT_EQ(BigNum((long double)0.1).num, ".1000000000000000055511151231257827021181583404541015625");
+  EXPECT_EQ(BigNum((long double)1208925819614629174706176.0).num, "1208925819614629174706176");
+  EXPECT_EQ(BigNum((long double)-0.0029296875), BigNum("-0.0029296875"));
+  EXPECT_EQ(BigNum((long double)0.0), BigNum(0LL));
+  EXPECT_THROW(BigNum(std::numeric_limits<long double>::infinity()), const char*);
+  EXPECT_THROW(BigNum(std::numeric_limits<long double>::quiet_NaN()), const char*);
+}
+
+TEST(BigNumTest, Magnitude) {
+  BigNum num1("-98765432109876543210.555");
+  EXPECT_EQ(num1.digits10(), 20);
+  EXPECT_EQ(num1.leading_digits(5), "98765");
+  EXPECT_EQ(num1.to_scientific(3), "-9.877e+19");
+  EXPECT_EQ(num1.to_double(), -98765432109876543210.555);
+  EXPECT_TRUE(std::isnan(num1.log10()));
+
+  BigNum num2("0.000999951");
+  EXPECT_EQ(num2.digits10(), 1);
+  EXPECT_EQ(num2.leading_digits(10), "999951");
+  EXPECT_EQ(num2.to_scientific(3), "1.000e-03");
+  EXPECT_EQ(num2.to_scientific(0), "1e-03");
+  EXPECT_EQ(BigNum().to_scientific(2), "0.00e+00");
+
+  // Far beyond double range
+  BigNum num3 = BigNum(1LL) << 5000;
+  EXPECT_EQ(num3.digits10(), 1506);
+  EXPECT_NEAR(num3.log2(), 5000.0, 1e-9);
+  EXPECT_NEAR(num3.log10(), 1505.1499783199059, 1e-9);
+  EXPECT_EQ(num3.to_double(), std::numeric_limits<double>::infinity());
+  EXPECT_EQ(BigNum().log10(), -std::numeric_limits<double>::infinity());
+
+  // A tie between two doubles broken only by a digit 1000 places in
+  BigNum tie("1.00000000000000011102230246251565404236316680908203125");
+  EXPECT_EQ(tie.to_double(), 1.0);
+  EXPECT_EQ(BigNum(tie.num + std::string(1000, '0') + "1").to_double(), 1.0000000000000002);
+
+  // Digits past the prefix only matter on a halfway point
+  EXPECT_EQ(BigNum("1." + std::string(5000, '3')).to_double(), 4.0 / 3.0);
+  EXPECT_EQ(BigNum("-" + std::string(5000, '9')).to_double(), -std::numeric_limits<double>::infinity());
+  EXPECT_EQ(BigNum(std::string(300, '9') + "." + std::string(5000, '9')).to_double(), 1e300);
+
+  // The decimal point stays right after in-place arithmetic, and k is capped by the length
+  BigNum r;
+  mul(r, num1, BigNum("1000"));
+  EXPECT_EQ(r.digits10(), 23);
+  add(r, num2, BigNum("0.5"));
+  EXPECT_EQ(r.digits10(), 1);
+  EXPECT_EQ(r.leading_digits(1LL << 60), "500999951");
+}
+
 TEST(BigNumTest, Addition) {
   BigNum num1("123456789");
   BigNum num2("987654321");
@@ -42,6 +137,11 @@ TEST(BigNumTest, Addition) {
   BigNum num5("987.654");
   BigNum num6 = num4 + num5;
   EXPECT_EQ(num6.num, "1111.11");
+
+  EXPECT_EQ(BigNum("-5") + BigNum("3"), BigNum("-2"));
+  EXPECT_EQ(BigNum("3") + BigNum("-5"), BigNum("-2"));
+  EXPECT_EQ(BigNum("0") + BigNum("-943"), BigNum("-943"));
+  EXPECT_EQ(BigNum("1.5") - BigNum("10"), BigNum("-8.5"));
 }
 
 TEST(BigNumTest, Subtraction) {
@@ -71,6 +171,78 @@ TEST(BigNumTest, Multiplication) {
   BigNum num8("16");
   BigNum num9 = num7 * num8;
   EXPECT_EQ(num9.num, "2");
+
+  EXPECT_EQ((BigNum("123456789012345678") * BigNum("987654321098765432")).num, "121932631137021794322511812221002896");
+  EXPECT_EQ((BigNum("12345678901234567890123") * BigNum("7")).num, "86419752308641975230861");
+  EXPECT_EQ(BigNum(-4LL) * BigNum(25LL), BigNum("-100"));
+
+  // (10^1000 - 1)^2 = 99...9800...01, past the schoolbook threshold
+  BigNum nines(std::string(1000, '9'));
+  EXPECT_EQ((nines * nines).num, std::string(999, '9') + "8" + std::string(999, '0') + "1");
+  EXPECT_EQ((nines * BigNum("3")).num, "2" + std::string(999, '9') + "7");
+
+  EXPECT_EQ((BigNum("123.4555") * BigNum("-0.0005")).num, ".06172775");
+}
+
+TEST(BigNumTest, OutputParameters) {
+  BigNum a("123456789.123"), b("-987.5"), r;
+  add(r, a, b);
+  EXPECT_EQ(r.num, "123455801.623");
+  mul(r, a, b);
+  EXPECT_EQ(r, BigNum("-121913579258.9625"));
+
+  r = BigNum(1LL);
+  addmul(r, a, b);
+  EXPECT_EQ(r, BigNum("-121913579257.9625"));
+  r = BigNum(1LL);
+  submul(r, a, b);
+  EXPECT_EQ(r, BigNum("121913579259.9625"));
+
+  // Outputs may alias inputs
+  r = BigNum("-0.5");
+  add(r, r, r);
+  EXPECT_EQ(r, BigNum(-1LL));
+  mul(r, r, r);
+  EXPECT_EQ(r, BigNum(1LL));
+  sub(r, r, r);
+  EXPECT_EQ(r, BigNum(0LL));
+  EXPECT_TRUE(r.sign);
+
+  BigNum q, m, x("1000000000000000000000000000007");
+  divmod(q, m, x, BigNum("123456789"));
+  EXPECT_EQ(q.num, "8100000073710000670761");
+  EXPECT_EQ(m.num, "753578");
+  divmod(q, x, BigNum("-1000000000000000000000000000007"), BigNum("123456789"));
+  EXPECT_EQ(q, BigNum("-8100000073710000670761"));
+  EXPECT_EQ(x, BigNum("-753578"));
+  EXPECT_THROW(divmod(q, m, x, BigNum()), const char*);
+  EXPECT_THROW(divmod(q, q, x, x), const char*);
+  EXPECT_THROW(divmod(q, m, BigNum("7.5"), BigNum("2")), const char*);
+  EXPECT_THROW(divmod(q, m, BigNum("7"), BigNum("-0.25")), const char*);
+
+  // Storage is reused
+  r.reserve(100);
+  size_t capacity = r.capacity();
+  EXPECT_GE(capacity, 100u);
+  for (int i = 0; i < 10; ++i) addmul(r, a, a);
+  EXPECT_EQ(r.capacity(), capacity);
+  r.shrink_to_fit();
+  EXPECT_LT(r.capacity(), capacity);
+
+  // Long operands take the Karatsuba path
+  std::string da, db;
+  for (int i = 0; i < 12000; ++i) {
+    da += (char)('1' + i * 7 % 9);
+    db += (char)('1' + i * 5 % 9);
+  }
+  BigNum c(da.substr(0, 6000) + "." + da.substr(6000)), d("-" + db), e = c * d;
+  mul(r, c, d);
+  EXPECT_EQ(r, e);
+  r = BigNum("0.5");
+  addmul(r, c, d);
+  EXPECT_EQ(r, e + BigNum("0.5"));
+  submul(r, c, d);
+  EXPECT_EQ(r, BigNum("0.5"));
 }
 
 TEST(BigNumTest, Division) {
@@ -87,6 +259,449 @@ TEST(BigNumTest, Division) {
   EXPECT_EQ(num9.num, "7057244");
 }
 
+TEST(BigNumTest, Shift) {
+  BigNum num1("123456789012345678901234567890");
+  EXPECT_EQ((num1 << 100).num, "156500072693749876333549759454926973536814597484617284976640");
+  EXPECT_EQ((num1 >> 37).num, "898266364037013255");
+  EXPECT_EQ((num1 >> 200).num, "0");
+
+  BigNum num2("-5");
+  EXPECT_EQ(num2 >> 1, BigNum(-3LL));
+  EXPECT_EQ(num2 << 3, BigNum(-40LL));
+}
+
+TEST(BigNumTest, Bitwise) {
+  BigNum num1("987654321098765432109876543210"), num2("123456789012345678901234567890");
+  EXPECT_EQ((num1 & num2).num, "1943960184490269435062782658");
+  EXPECT_EQ((num1 | num2).num, "1109167149926620841576048328442");
+  EXPECT_EQ((num1 ^ num2).num, "1107223189742130572140985545784");
+  EXPECT_EQ(BigNum(-12LL) & BigNum(10LL), BigNum(0LL));
+  EXPECT_EQ(BigNum(-12LL) | BigNum(10LL), BigNum(-2LL));
+  EXPECT_EQ(BigNum(-12LL) ^ BigNum(-10LL), BigNum(2LL));
+  EXPECT_EQ(~BigNum(7LL), BigNum(-8LL));
+
+  EXPECT_EQ(num1.bit_length(), 100);
+  EXPECT_EQ(num1.popcount(), 54);
+  EXPECT_EQ(num1.trailing_zeros(), 1);
+  EXPECT_EQ((BigNum(3LL) << 70).trailing_zeros(), 70);
+  EXPECT_TRUE(num1.test_bit(99));
+  EXPECT_FALSE(num1.test_bit(100));
+  EXPECT_TRUE(BigNum(-1LL).test_bit(1000));
+
+  BigNum num3 = BigNum(1LL) << 5000;
+  EXPECT_EQ(num3.bit_length(), 5001);
+  EXPECT_EQ((num3 - 1LL).bit_length(), 5000);
+  EXPECT_EQ((BigNum(0LL) - num3).bit_length(), 5001);
+
+  BigNum num4("2.5");
+  EXPECT_THROW(num4 << 1, const char*);
+  EXPECT_THROW(num4 >> 1, const char*);
+  EXPECT_THROW(num4 & num1, const char*);
+  EXPECT_THROW(num1 | num4, const char*);
+  EXPECT_THROW(~num4, const char*);
+  EXPECT_THROW(num4.bit_length(), const char*);
+  EXPECT_THROW(num4.popcount(), const char*);
+  EXPECT_THROW(num4.test_bit(0), const char*);
+  EXPECT_THROW(num4.trailing_zeros(), const char*);
+}
+
+TEST(FixedBigNumTest, Literal) {
+  constexpr auto num1 = 123456789012345678901234567890_bn;
+  static_assert(decltype(num1)::bits == 128, "30 digits fit in 128 bits");
+  static_assert(num1 % FixedBigNum<128>(1000000000ULL) == FixedBigNum<128>(234567890ULL), "evaluated at compile time");
+  EXPECT_EQ(num1.to_bignum().num, "123456789012345678901234567890");
+
+  constexpr FixedBigNum<256> num2 = 0xFFFF'FFFF'FFFF'FFFF'FFFF_bn;
+  EXPECT_EQ(num2.bit_length(), 80u);
+  EXPECT_EQ(num2.to_bignum().num, "1208925819614629174706175");
+
+  static_assert(010_bn == FixedBigNum<64>(8ULL), "leading 0 is octal");
+  static_assert(0b101_bn == FixedBigNum<64>(5ULL), "0b is binary");
+  static_assert(0X1f_bn == FixedBigNum<64>(31ULL), "0X is hexadecimal");
+  static_assert(0_bn == FixedBigNum<64>(0ULL), "lone 0 is decimal");
+  static_assert(decltype(0b1'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000'0000_bn)::bits == 128, "one bit per binary digit");
+  EXPECT_THROW(FixedBigNum<64>::parse("09", 2), const char*);
+}
+
+TEST(FixedBigNumTest, Arithmetic) {
+  FixedBigNum<256> num1(BigNum("987654321098765432109876543210"));
+  FixedBigNum<256> num2(BigNum("123456789012345678901234567890"));
+  EXPECT_EQ((num1 + num2).to_bignum().num, "1111111110111111111011111111100");
+  EXPECT_EQ((num1 - num2).to_bignum().num, "864197532086419753208641975320");
+  EXPECT_EQ((num1 * num2).to_bignum().num, "121932631137021795226185032733622923332237463801111263526900");
+  EXPECT_EQ((num1 / num2).to_bignum().num, "8");
+  EXPECT_EQ((num1 % num2).to_bignum().num, "9000000000900000000090");
+
+  FixedBigNum<128> num3 = FixedBigNum<128>(0ULL) - FixedBigNum<128>(1ULL);
+  EXPECT_EQ(num3.to_bignum().num, "340282366920938463463374607431768211455");
+  EXPECT_EQ((num3 >> 100).to_bignum().num, "268435455");
+  EXPECT_EQ((FixedBigNum<128>(1ULL) << 127).to_bignum().num, "170141183460469231731687303715884105728");
+  EXPECT_TRUE(num3 > FixedBigNum<128>(1ULL) << 127);
+}
+
+TEST(FixedBigNumTest, Conversion) {
+  EXPECT_THROW(FixedBigNum<64>(BigNum("18446744073709551616")), const char *);
+  EXPECT_THROW(FixedBigNum<64>(BigNum("-1")), const char *);
+  EXPECT_EQ(FixedBigNum<64>(BigNum("18446744073709551615")).to_bignum().num, "18446744073709551615");
+  EXPECT_EQ(FixedBigNum<512>(BigNum("0")).to_bignum().num, "0");
+}
+
+TEST(BigNumUtilsTest, Fibonacci) {
+  EXPECT_EQ(fibonacci(0).num, "0");
+  EXPECT_EQ(fibonacci(1).num, "1");
+  EXPECT_EQ(fibonacci(100).num, "354224848179261915075");
+  EXPECT_EQ(fibonacci(-8), BigNum(-21LL));
+  EXPECT_EQ(fibonacci(1000, BigNum("1000000007")).num, "517691607");
+
+  BigNum f = fibonacci(100000);
+  EXPECT_EQ(f.num.length(), 20899u);
+  EXPECT_EQ(f.num.substr(0, 10), "2597406934");
+  EXPECT_EQ(f.num.substr(20889), "3428746875");
+
+  EXPECT_EQ(lucas(0).num, "2");
+  EXPECT_EQ(lucas(100).num, "792070839848372253127");
+  EXPECT_EQ(lucas(-5), BigNum(-11LL));
+  EXPECT_EQ(lucas(100, BigNum("1000")).num, "127");
+
+  const long long min = std::numeric_limits<long long>::min();
+  EXPECT_EQ(fibonacci(min, BigNum("10")).num, "9");
+  EXPECT_EQ(lucas(min, BigNum("10")).num, "7");
+}
+
+TEST(BigNumUtilsTest, LinearRecurrence) {
+  std::vector<BigNum> fib = {BigNum(1LL), BigNum(1LL)}, fibInit = {BigNum(0LL), BigNum(1LL)};
+  EXPECT_EQ(linear_recurrence(fib, fibInit, 100), fibonacci(100));
+  EXPECT_EQ(linear_recurrence(fib, fibInit, 1000, BigNum("1000000007")).num, "517691607");
+
+  // Tribonacci: 0, 0, 1, 1, 2, 4, 7, 13, 24, 44, 81, ...
+  std::vector<BigNum> trib = {BigNum(1LL), BigNum(1LL), BigNum(1LL)}, tribInit = {BigNum(0LL), BigNum(0LL), BigNum(1LL)};
+  EXPECT_EQ(linear_recurrence(trib, tribInit, 10).num, "81");
+  EXPECT_EQ(linear_recurrence(trib, tribInit, 37).num, "1132436852");
+
+  // Powers of three
+  std::vector<BigNum> pow3 = {BigNum(3LL)}, pow3Init = {BigNum(1LL)};
+  EXPECT_EQ(linear_recurrence(pow3, pow3Init, 40), pow(BigNum(3LL), BigNum(40LL)));
+  EXPECT_THROW(linear_recurrence(pow3, pow3Init, -1), const char*);
+}
+
+TEST(BigNumUtilsTest, Montgomery) {
+  Montgomery ctx(BigNum("998244353"));
+  BigNum a = ctx.to_mont(BigNum("123456789")), b = ctx.to_mont(BigNum("987654321"));
+  EXPECT_EQ(ctx.from_mont(ctx.mul(a, b)).num, "263684735");
+  EXPECT_EQ(ctx.pow(BigNum(7LL), BigNum("123456789")).num, "60216523");
+  EXPECT_THROW(Montgomery(BigNum("1000")), const char *);
+
+  EXPECT_EQ(powmod(BigNum(7LL), BigNum("123456789"), BigNum("1000000000")).num, "776429607");
+  EXPECT_EQ(powmod(BigNum(2LL), BigNum("1000"), BigNum("1000000007")).num, "688423210");
+}
+
+TEST(BigNumUtilsTest, Primes) {
+  EXPECT_FALSE(is_probable_prime(BigNum(1LL)));
+  EXPECT_TRUE(is_probable_prime(BigNum(2LL)));
+  EXPECT_TRUE(is_probable_prime(BigNum(1999LL)));
+  EXPECT_FALSE(is_probable_prime(BigNum(5459LL)));
+  EXPECT_FALSE(is_probable_prime(BigNum("3215031751")));
+  EXPECT_FALSE(is_probable_prime(BigNum("3825123056546413051")));
+  EXPECT_TRUE(is_probable_prime(BigNum("2305843009213693951")));
+  EXPECT_TRUE(is_probable_prime(BigNum("170141183460469231731687303715884105727")));
+
+  EXPECT_EQ(next_prime(BigNum(0LL)).num, "2");
+  EXPECT_EQ(next_prime(BigNum("1000000000000000000000")).num, "1000000000000000000117");
+
+  std::vector<BigNum> primes = find_primes(BigNum("100000000000"), BigNum("100000000100"));
+  ASSERT_EQ(primes.size(), 7u);
+  EXPECT_EQ(primes.front().num, "100000000003");
+  EXPECT_EQ(primes.back().num, "100000000091");
+
+  // Starts past the small primes, against a plain sieve
+  const int limit = 30000;
+  std::vector<bool> sieve(limit + 1, true);
+  std::vector<BigNum> expected;
+  for (int i = 2; i <= limit; ++i) {
+    if (!sieve[i]) continue;
+    if (i >= 10000) expected.push_back(BigNum((long long)i));
+    for (int j = 2 * i; j <= limit; j += i) sieve[j] = false;
+  }
+  ThreadPool pool(2);
+  EXPECT_EQ(find_primes(BigNum(10000LL), BigNum((long long)limit), pool), expected);
+  for (long long n = 14000; n < 14100; ++n) {
+    long long p = n + 1;
+    while (!sieve[p]) ++p;
+    EXPECT_EQ(next_prime(BigNum(n)), BigNum(p));
+  }
+  EXPECT_EQ(next_prime(BigNum(10074LL)).num, "10079");
+}
+
+TEST(BigNumBinaryTest, RoundTrip) {
+  std::vector<BigNum> nums = {BigNum("0"), BigNum("-1"), BigNum("1234.56789"), BigNum("-0.000123"),
+                              BigNum("987654321098765432109876543210"), BigNum("1000000000")};
+  std::stringstream ss;
+  write_binary(ss, nums);
+  std::vector<BigNum> back = read_binary_vector(ss);
+  ASSERT_EQ(back.size(), nums.size());
+  for (size_t i = 0; i < nums.size(); ++i) EXPECT_EQ(back[i], nums[i]);
+
+  EXPECT_EQ(binary_size(BigNum("987654321098765432109876543210")), 12u + 16u);
+  EXPECT_EQ(binary_size(BigNum("-0.000123")), 12u + 4u);
+
+  std::stringstream bad("BGNX");
+  EXPECT_THROW(read_binary_vector(bad), const char *);
+}
+
+TEST(BigNumBinaryTest, View) {
+  std::vector<BigNum> nums = {BigNum("-5"), BigNum("12.5"), BigNum("12.25"), BigNum("123456789123456789")};
+  std::stringstream ss;
+  write_binary(ss, nums);
+  std::string buf = ss.str();
+
+  BigNumArrayView view(reinterpret_cast<const unsigned char *>(buf.data()), buf.size());
+  ASSERT_EQ(view.size(), 4u);
+  EXPECT_EQ(view[3].count, 2u);
+  EXPECT_EQ(view[3].limb(0), 123456789u);
+  EXPECT_EQ(view[1].to_bignum().num, "12.5");
+  EXPECT_TRUE(view[0] < view[1]);
+  EXPECT_TRUE(view[2] < view[1]);
+  EXPECT_TRUE(view[3] > view[1]);
+  EXPECT_TRUE(view[1] == view[1]);
+
+  EXPECT_THROW(BigNumArrayView(reinterpret_cast<const unsigned char *>(buf.data()), buf.size() - 1), const char *);
+
+  BigNumAccumulator acc;
+  for (size_t i = 0; i < view.size(); ++i) acc += view[i];
+  acc -= view[1];
+  EXPECT_EQ(acc.value(), nums[0] + nums[2] + nums[3]);
+}
+
+TEST(BigNumBinaryTest, Corrupted) {
+  std::vector<BigNum> nums = {BigNum("-5"), BigNum("12.5"), BigNum("123456789123456789")};
+  std::stringstream ss;
+  write_binary(ss, nums);
+  const std::string buf = ss.str();
+  auto read = [](const std::string &bytes) {
+    std::stringstream in(bytes);
+    return read_binary_vector(in);
+  };
+  auto view = [](const std::string &bytes) {
+    return BigNumArrayView(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+  };
+
+  // Limb of 10 ^ 9 or more in the last record
+  std::string limb = buf;
+  limb[60] = limb[61] = limb[62] = limb[63] = '\xff';
+  EXPECT_THROW(read(limb), const char *);
+  EXPECT_THROW(view(limb)[2].to_bignum(), const char *);
+
+  // Record and file counts far past the data
+  std::string count = buf;
+  count[19] = '\x7f';
+  EXPECT_THROW(read(count), const char *);
+  EXPECT_THROW(view(count), const char *);
+  count = buf;
+  count[15] = '\x7f';
+  EXPECT_THROW(read(count), const char *);
+  EXPECT_THROW(view(count), const char *);
+
+  // Scale far past the digits, and unknown flags
+  std::string scale = buf;
+  scale[39] = '\x7f';
+  EXPECT_THROW(read(scale), const char *);
+  EXPECT_THROW(view(scale), const char *);
+  std::string flags = buf;
+  flags[40] = '\x02';
+  EXPECT_THROW(read(flags), const char *);
+
+  // Zero top limb, which would make 123456789 compare above 5
+  std::string top = buf;
+  top[64] = top[65] = top[66] = top[67] = '\0';
+  EXPECT_THROW(read(top), const char *);
+  EXPECT_THROW(view(top), const char *);
+  const unsigned char record[20] = {2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0};
+  EXPECT_THROW(BigNumView(record, sizeof(record)), const char *);
+}
+
+TEST(BigNumBatchTest, Batch) {
+  ThreadPool pool(4);
+  std::vector<BigNum> a = {BigNum("12"), BigNum("123456789012345678901234567890"), BigNum("0"), BigNum("1071")};
+  std::vector<BigNum> b = {BigNum("18"), BigNum("9876543210"), BigNum("5"), BigNum("462")};
+
+  std::vector<BigNum> g = batch_gcd(a, b, pool);
+  EXPECT_EQ(g[0].num, "6");
+  EXPECT_EQ(g[1].num, "90");
+  EXPECT_EQ(g[2].num, "5");
+  EXPECT_EQ(g[3].num, "21");
+
+  std::vector<std::pair<BigNum, BigNum>> qr = batch_divmod(a, b, pool);
+  EXPECT_EQ(qr[1].first.num, "12499999887343749990");
+  EXPECT_EQ(qr[1].second.num, "1562499990");
+  EXPECT_EQ(qr[3].first.num, "2");
+  EXPECT_EQ(qr[3].second.num, "147");
+
+  std::vector<BigNum> p = batch_powmod(b, a, std::vector<BigNum>(4, BigNum("1000000007")), pool);
+  EXPECT_EQ(p[0].num, "373328359");
+  EXPECT_EQ(p[3].num, powmod(BigNum("462"), BigNum("1071"), BigNum("1000000007")).num);
+
+  std::vector<BigNum> sq = parallel_transform(a, [](const BigNum &x) { BigNum y = x; return y * y; }, pool);
+  EXPECT_EQ(sq[0].num, "144");
+  EXPECT_EQ(sq[3].num, "1147041");
+
+  // Batches started from inside a task run inline instead of deadlocking
+  std::vector<BigNum> nested = parallel_transform(a, [&](const BigNum &x) {
+    return batch_gcd(std::vector<BigNum>(3, x), std::vector<BigNum>(3, BigNum("18")), pool)[2];
+  }, pool);
+  EXPECT_EQ(nested[0].num, "6");
+  EXPECT_EQ(nested[2].num, "18");
+  EXPECT_THROW(parallel_transform(a, [&](const BigNum &x) { return batch_gcd({x}, {}, pool)[0]; }, pool), const char *);
+
+  EXPECT_THROW(batch_gcd(a, std::vector<BigNum>(3), pool), const char *);
+  EXPECT_THROW(batch_divmod(a, std::vector<BigNum>(4), pool), const char *);
+}
+
+TEST(BigNumBatchTest, ProductTreeGcd) {
+  // 1000003 * 1000033, 1000003 * 1000037, 1000039 * 1000081, 999983 * 1000033
+  std::vector<BigNum> n = {BigNum("1000036000099"), BigNum("1000040000111"), BigNum("1000120003159"), BigNum("1000015999439")};
+  std::vector<BigNum> g = product_tree_gcd(n);
+  EXPECT_EQ(g[0].num, "1000036000099");
+  EXPECT_EQ(g[1].num, "1000003");
+  EXPECT_EQ(g[2].num, "1");
+  EXPECT_EQ(g[3].num, "1000033");
+}
+
+TEST(BigNumDivisorTest, Small) {
+  BigNumDivisor div(BigNum("1000000007"));
+  EXPECT_TRUE(div.small);
+  std::pair<BigNum, BigNum> qr = div.divmod(BigNum("123456789012345678901234567890"));
+  EXPECT_EQ(qr.first.num, "123456788148148161864");
+  EXPECT_EQ(qr.second.num, "197434842");
+  EXPECT_EQ(div.mod(BigNum("-1000000008")), BigNum(-1LL));
+  EXPECT_TRUE(div.divides(BigNum("2000000014")));
+  EXPECT_FALSE(div.divides(BigNum("2000000015")));
+}
+
+TEST(BigNumDivisorTest, Large) {
+  BigNumDivisor div(BigNum("123456789012345678901"));
+  EXPECT_FALSE(div.small);
+  BigNum x("987654321098765432109876543210987654321098765432109876543210");
+  EXPECT_EQ(div.div(x), BigNum(x) / BigNum("123456789012345678901"));
+  EXPECT_EQ(div.mod(x), BigNum(x) % BigNum("123456789012345678901"));
+  EXPECT_TRUE(div.divides(BigNum("123456789012345678901") * BigNum("99999999999")));
+  EXPECT_THROW(BigNumDivisor(BigNum(0LL)), const char *);
+}
+
+TEST(BigNumDivisorTest, Decimal) {
+  EXPECT_THROW(BigNumDivisor(BigNum("1.5")), const char *);
+  EXPECT_THROW(BigNumDivisor(BigNum("12345678901234567890.5")), const char *);
+  EXPECT_THROW(BigNumDivisor(BigNum("7")).divmod(BigNum("10.5")), const char *);
+  EXPECT_THROW(BigNumDivisor(BigNum("7")).divides(BigNum("10.5")), const char *);
+  EXPECT_THROW(BigNumDivisor(BigNum("123456789012345678901")).mod(BigNum("-10.5")), const char *);
+}
+
+TEST(BigNumUtilsTest, DivExact) {
+  BigNum a("121932631137021795226185032733622923332237463801111263526900"), b("123456789012345678901234567890");
+  EXPECT_EQ(divexact(a, b).num, "987654321098765432109876543210");
+  EXPECT_EQ(divexact(BigNum("-1024000"), BigNum("128")), BigNum(-8000LL));
+  EXPECT_EQ(divexact(BigNum("390625"), BigNum("-625")), BigNum(-625LL));
+
+  BigNum c("1071"), d("462");
+  EXPECT_EQ(lcm(c, d).num, "23562");
+}
+
+TEST(BigNumAccumulatorTest, Sum) {
+  BigNumAccumulator acc;
+  BigNum total;
+  for (long long i = 1; i <= 1000; ++i) {
+    BigNum x = BigNum("123456789012345678901234567890") * i;
+    acc += x;
+    total += x;
+  }
+  EXPECT_EQ(acc.value(), total);
+
+  acc -= total;
+  acc -= BigNum("0.5");
+  EXPECT_EQ(acc.value(), BigNum("-0.5"));
+
+  acc.clear();
+  acc += BigNum("1234.56789");
+  acc += BigNum("-0.000000000001");
+  EXPECT_EQ(acc.value().num, "1234.567889999999");
+}
+
+TEST(BigNumAccumulatorTest, DotProduct) {
+  std::vector<BigNum> a = {BigNum("987654321098765432109876543210"), BigNum("-12.5"), BigNum("3")};
+  std::vector<BigNum> b = {BigNum("123456789012345678901234567890"), BigNum("4"), BigNum("-0.25")};
+  BigNumAccumulator acc;
+  for (size_t i = 0; i < a.size(); ++i) acc.add_product(a[i], b[i]);
+  EXPECT_EQ(acc.value().num, "121932631137021795226185032733622923332237463801111263526849.25");
+
+  acc.sub_product(a[0], b[0]);
+  EXPECT_EQ(acc.value(), BigNum("-50.75"));
+
+  // A large negative top limb is split like any other carry
+  acc.clear();
+  acc.limbs = {-5, -8000000000000000000LL};
+  acc.normalize();
+  for (int64_t limb : acc.limbs) EXPECT_LT(limb < 0 ? -limb : limb, 1000000000);
+  EXPECT_EQ(acc.value(), BigNum("-8000000000000000000000000005"));
+}
+
+TEST(BigNumPolyTest, Multiplication) {
+  BigNumPoly a({BigNum("1"), BigNum("1")});
+  BigNumPoly b({BigNum("-1"), BigNum("1")});
+  EXPECT_EQ(a * b, BigNumPoly({BigNum("-1"), BigNum("0"), BigNum("1")}));
+
+  std::vector<BigNum> c, d;
+  for (long long i = 1; i <= 20; ++i) {
+    c.push_back(BigNum("123456789012345678901234567890") * (i % 3 ? i : -i));
+    d.push_back(BigNum("-98765432109876543210") + i * i);
+  }
+  BigNumPoly p(c), q(d);
+  EXPECT_EQ(p.mul_kronecker(q), p.mul_naive(q));
+  EXPECT_EQ(p * q, p.mul_naive(q));
+  EXPECT_EQ((p * q).degree(), 38);
+
+  BigNumPoly e({BigNum("0.5"), BigNum("-1.25")});
+  EXPECT_EQ(e.mul_kronecker(e), BigNumPoly({BigNum("0.25"), BigNum("-1.25"), BigNum("1.5625")}));
+  EXPECT_EQ(BigNumPoly() * p, BigNumPoly());
+  EXPECT_EQ(p.mul_naive(BigNumPoly()), BigNumPoly());
+  EXPECT_EQ(BigNumPoly().mul_naive(BigNumPoly()), BigNumPoly());
+  EXPECT_EQ(p.mul_kronecker(BigNumPoly()), BigNumPoly());
+  EXPECT_EQ(BigNumPoly().mul_kronecker(p), BigNumPoly());
+}
+
+TEST(BigNumPolyTest, DivMod) {
+  BigNumPoly a({BigNum("5"), BigNum("-2"), BigNum("0"), BigNum("1")});
+  BigNumPoly b({BigNum("-3"), BigNum("1")});
+  std::pair<BigNumPoly, BigNumPoly> qr = a.divmod(b);
+  EXPECT_EQ(qr.first, BigNumPoly({BigNum("7"), BigNum("3"), BigNum("1")}));
+  EXPECT_EQ(qr.second, BigNumPoly({BigNum("26")}));
+
+  std::vector<BigNum> c, d;
+  for (long long i = 1; i <= 30; ++i) c.push_back(BigNum("31415926535897932384626") * (i % 4 ? i : -i));
+  for (long long i = 1; i <= 10; ++i) d.push_back(BigNum(i * i - 50));
+  d.push_back(BigNum("-1"));
+  BigNumPoly p(c), q(d);
+  EXPECT_EQ(q * (p / q) + p % q, p);
+  EXPECT_LT((p % q).degree(), q.degree());
+
+  EXPECT_THROW(a.divmod(BigNumPoly()), const char*);
+  EXPECT_THROW(a.divmod(BigNumPoly({BigNum("1"), BigNum("2")})), const char*);
+}
+
+TEST(BigNumPolyTest, Evaluation) {
+  BigNumPoly p({BigNum("1"), BigNum("-2"), BigNum("3")});
+  EXPECT_EQ(p.eval(BigNum("-2")), BigNum("17"));
+  EXPECT_EQ(p.eval(BigNum("100000000000000000000")).num, "29999999999999999999800000000000000000001");
+
+  std::vector<BigNum> c, points;
+  for (long long i = 0; i < 40; ++i) {
+    c.push_back(BigNum("2718281828459045") * (i % 2 ? i : -i));
+    points.push_back(BigNum(i * 1000003 - 20000000));
+  }
+  BigNumPoly q(c);
+  std::vector<BigNum> values = q.eval(points);
+  EXPECT_EQ(q.eval_tree(points), values);
+  for (size_t i = 0; i < points.size(); ++i) EXPECT_EQ(values[i], q.eval(points[i]));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();